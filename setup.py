@@ -54,6 +54,8 @@ sources = [
     os.path.join(src_main_c_dir, 'jpy_jobj.c'),
     os.path.join(src_main_c_dir, 'jpy_jmethod.c'),
     os.path.join(src_main_c_dir, 'jpy_jfield.c'),
+    os.path.join(src_main_c_dir, 'jpy_async.c'),
+    os.path.join(src_main_c_dir, 'jpy_watchdog.c'),
     os.path.join(src_main_c_dir, 'jni/org_jpy_PyLib.c'),
 ]
 
@@ -67,6 +69,8 @@ headers = [
     os.path.join(src_main_c_dir, 'jpy_jobj.h'),
     os.path.join(src_main_c_dir, 'jpy_jmethod.h'),
     os.path.join(src_main_c_dir, 'jpy_jfield.h'),
+    os.path.join(src_main_c_dir, 'jpy_async.h'),
+    os.path.join(src_main_c_dir, 'jpy_watchdog.h'),
     os.path.join(src_main_c_dir, 'jni/org_jpy_PyLib.h'),
 ]
 
@@ -91,6 +95,8 @@ python_java_jpy_tests = [
     os.path.join(src_test_py_dir, 'jpy_modretparam_test.py'),
     os.path.join(src_test_py_dir, 'jpy_translation_test.py'),
     os.path.join(src_test_py_dir, 'jpy_gettype_test.py'),
+    os.path.join(src_test_py_dir, 'jpy_async_test.py'),
+    # os.path.join(src_test_py_dir, 'jpy_mt_perf_test.py'),
 ]
 
 # e.g. jdk_home_dir = '/home/marta/jdk1.7.0_15'
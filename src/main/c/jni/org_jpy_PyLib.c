@@ -25,6 +25,8 @@
 #include "jpy_jtype.h"
 #include "jpy_jobj.h"
 #include "jpy_conv.h"
+#include "jpy_async.h"
+#include "jpy_watchdog.h"
 
 #include "org_jpy_PyLib.h"
 #include "org_jpy_PyLib_Diag.h"
@@ -34,15 +36,22 @@
 
 PyObject* PyLib_GetAttributeObject(JNIEnv* jenv, PyObject* pyValue, jstring jName);
 PyObject* PyLib_CallAndReturnObject(JNIEnv *jenv, PyObject* pyValue, jboolean isMethodCall, jstring jName, jint argCount, jobjectArray jArgs, jobjectArray jParamClasses);
+PyObject* PyLib_NewArgsTuple(JNIEnv *jenv, const char* nameChars, jint argCount, jobjectArray jArgs, jobjectArray jParamClasses, JPy_JType** paramTypes);
+PyObject* PyLib_CallCallable(JNIEnv *jenv, PyObject* pyCallable, const char* nameChars, jint argCount, jobjectArray jArgs, jobjectArray jParamClasses, JPy_JType** paramTypes);
+PyObject* PyLib_CallWithPrimitiveArgs(JNIEnv* jenv, PyObject* pyCallable, jint argCount, jint doubleArgs, const jlong* args);
 void PyLib_HandlePythonException(JNIEnv* jenv);
+char* PyLib_FormatPythonException(PyObject* pyType, PyObject* pyValue, PyObject* pyTraceback);
 void PyLib_ThrowOOM(JNIEnv* jenv);
 void PyLib_ThrowFNFE(JNIEnv* jenv, const char *file);
 void PyLib_ThrowUOE(JNIEnv* jenv, const char *message);
 void PyLib_ThrowRTE(JNIEnv* jenv, const char *message);
+void PyLib_ThrowIOOBE(JNIEnv* jenv, jint index);
+PyObject* PyLib_NewKeyObject(JNIEnv* jenv, jobject jKey);
 void PyLib_RedirectStdOut(void);
-int copyPythonDictToJavaMap(JNIEnv *jenv, PyObject *pyDict, jobject jMap);
+int copyPythonDictChangesToJavaMap(JNIEnv *jenv, PyObject *pyDict, PyObject *pySnapshot, jobject jMap);
 
-static int JPy_InitThreads = 0;
+// Set once the thread which initialized Python has released the GIL, guarded by the globals lock
+static volatile int JPy_InitThreads = 0;
 
 //#define JPy_JNI_DEBUG 1
 #define JPy_JNI_DEBUG 0
@@ -54,10 +63,36 @@ static int JPy_InitThreads = 0;
 
 #define JPy_GIL_AWARE
 
+// The number of org.jpy.GilScope instances open in the current thread. While greater than zero,
+// the current thread holds the GIL, so the native entry points neither acquire nor release it.
+static JPy_THREAD_LOCAL int JPy_GilScopeDepth = 0;
+// The GIL holder replaced by the outermost GilScope of the current thread, see JWatchdog_EnterJava(),
+// or -2 if the scope has been opened while the GIL watchdog didn't run.
+static JPy_THREAD_LOCAL int JPy_GilScopePreviousHolder = -2;
+
+#ifdef JPy_GIL_AWARE
+/**
+ * Releases the GIL held since Python has been initialized by the current thread.
+ * The globals lock makes sure it is done once in free-threaded Python builds.
+ */
+static void JPy_InitThreadsOnce(void)
+{
+    JPy_BEGIN_GLOBALS_LOCK
+    if (!JPy_InitThreads) {
+        PyEval_InitThreads();
+        PyEval_SaveThread();
+        JPy_InitThreads = 1;
+    }
+    JPy_END_GLOBALS_LOCK
+}
+#endif
+
 #ifdef JPy_GIL_AWARE
-    #define JPy_BEGIN_GIL_STATE  { PyGILState_STATE gilState; if (!JPy_InitThreads) {JPy_InitThreads = 1; PyEval_InitThreads(); PyEval_SaveThread(); } gilState = PyGILState_Ensure();
-    #define JPy_END_GIL_STATE    PyGILState_Release(gilState); }
+    #define JPy_INIT_THREADS     if (!JPy_InitThreads) { JPy_InitThreadsOnce(); }
+    #define JPy_BEGIN_GIL_STATE  { PyGILState_STATE gilState = PyGILState_UNLOCKED; int gilAcquired = JPy_GilScopeDepth == 0; if (gilAcquired) { JPy_INIT_THREADS JPy_ENSURE_GIL(jenv, gilState); }
+    #define JPy_END_GIL_STATE    if (gilAcquired) { PyGILState_Release(gilState); } }
 #else
+    #define JPy_INIT_THREADS
     #define JPy_BEGIN_GIL_STATE
     #define JPy_END_GIL_STATE
 #endif
@@ -338,6 +373,161 @@ JNIEXPORT void JNICALL Java_org_jpy_PyLib_stopPython0
 }
 
 
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    hasGil
+ * Signature: ()Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_jpy_PyLib_hasGil
+  (JNIEnv* jenv, jclass jLibClass)
+{
+    if (JPy_GilScopeDepth > 0) {
+        return JNI_TRUE;
+    }
+#if PY_VERSION_HEX >= 0x03040000
+    return PyGILState_Check() ? JNI_TRUE : JNI_FALSE;
+#else
+    return JNI_FALSE;
+#endif
+}
+
+
+int JPy_SuspendGilScopes(int* previousHolder)
+{
+    int depth = JPy_GilScopeDepth;
+    *previousHolder = JPy_GilScopePreviousHolder;
+    if (JPy_GilScopePreviousHolder != -2) {
+        // The thread won't hold the GIL while running Java code
+        JWatchdog_ExitJava(JPy_GilScopePreviousHolder);
+    }
+    JPy_GilScopeDepth = 0;
+    JPy_GilScopePreviousHolder = -2;
+    return depth;
+}
+
+void JPy_ResumeGilScopes(JNIEnv* jenv, int depth, int previousHolder)
+{
+    JPy_GilScopeDepth = depth;
+    JPy_GilScopePreviousHolder = previousHolder;
+    if (previousHolder != -2) {
+        JWatchdog_EnterJava(jenv);
+    }
+}
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    setGilWatchdogEnabled
+ * Signature: (Z)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_jpy_PyLib_setGilWatchdogEnabled
+  (JNIEnv* jenv, jclass jLibClass, jboolean enabled)
+{
+    return JWatchdog_SetEnabled(jenv, enabled);
+}
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    getGilWatchdogState
+ * Signature: ()[J
+ */
+JNIEXPORT jlongArray JNICALL Java_org_jpy_PyLib_getGilWatchdogState
+  (JNIEnv* jenv, jclass jLibClass)
+{
+    return JWatchdog_GetState(jenv);
+}
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    releaseGilWatchdogThreads
+ * Signature: ([J)V
+ */
+JNIEXPORT void JNICALL Java_org_jpy_PyLib_releaseGilWatchdogThreads
+  (JNIEnv* jenv, jclass jLibClass, jlongArray jThreadIds)
+{
+    JWatchdog_ReleaseThreads(jenv, jThreadIds);
+}
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    dumpPythonStacks
+ * Signature: ()Ljava/lang/String;
+ */
+JNIEXPORT jstring JNICALL Java_org_jpy_PyLib_dumpPythonStacks
+  (JNIEnv* jenv, jclass jLibClass)
+{
+    return JWatchdog_DumpPythonStacks(jenv);
+}
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    acquireGil0
+ * Signature: ()J
+ */
+JNIEXPORT jlong JNICALL Java_org_jpy_PyLib_acquireGil0
+  (JNIEnv* jenv, jclass jLibClass)
+{
+    jlong gilState = 0;
+
+#ifdef JPy_GIL_AWARE
+    PyGILState_STATE state;
+    JPy_INIT_THREADS
+    JPy_ENSURE_GIL(jenv, state);
+    gilState = (jlong) state;
+#endif
+    if (JPy_GilScopeDepth == 0) {
+        // Code running within the scope is Java code holding the GIL
+        JPy_GilScopePreviousHolder = JPy_WatchdogEnabled ? JWatchdog_EnterJava(jenv) : -2;
+    }
+    JPy_GilScopeDepth++;
+
+    JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "Java_org_jpy_PyLib_acquireGil0: gilScopeDepth=%d\n", JPy_GilScopeDepth);
+
+    return gilState;
+}
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    releaseGil0
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_org_jpy_PyLib_releaseGil0
+  (JNIEnv* jenv, jclass jLibClass, jlong gilState)
+{
+    if (JPy_GilScopeDepth <= 0) {
+        JPy_DIAG_PRINT(JPy_DIAG_F_ALL, "Java_org_jpy_PyLib_releaseGil0: error: GIL not acquired by this thread\n");
+        return;
+    }
+
+    JPy_GilScopeDepth--;
+    if (JPy_GilScopeDepth == 0 && JPy_GilScopePreviousHolder != -2) {
+        JWatchdog_ExitJava(JPy_GilScopePreviousHolder);
+        JPy_GilScopePreviousHolder = -2;
+    }
+
+    JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "Java_org_jpy_PyLib_releaseGil0: gilScopeDepth=%d\n", JPy_GilScopeDepth);
+
+#ifdef JPy_GIL_AWARE
+    PyGILState_Release((PyGILState_STATE) gilState);
+#endif
+}
+
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    completeFuture
+ * Signature: (JLjava/lang/Object;Ljava/lang/Throwable;)V
+ */
+JNIEXPORT void JNICALL Java_org_jpy_PyLib_completeFuture
+  (JNIEnv* jenv, jclass jLibClass, jlong futureRef, jobject jValue, jthrowable jError)
+{
+    JPy_BEGIN_GIL_STATE
+
+    JAsync_CompleteFuture(jenv, (PyObject*) futureRef, jValue, jError);
+
+    JPy_END_GIL_STATE
+}
+
+
 /*
  * Class:     org_jpy_PyLib
  * Method:    getPythonVersion
@@ -430,7 +620,7 @@ void dumpDict(const char* dictName, PyObject* dict)
 /**
  * Get the globals from the __main__ module.
  */
-PyObject *getMainGlobals() {
+PyObject *getMainGlobals(JNIEnv* jenv) {
     PyObject* pyMainModule;
     PyObject* pyGlobals;
 
@@ -454,7 +644,7 @@ JNIEXPORT jobject JNICALL Java_org_jpy_PyLib_getMainGlobals
         (JNIEnv *jenv, jclass libClass) {
     jobject objectRef;
 
-    PyObject *globals = getMainGlobals();
+    PyObject *globals = getMainGlobals(jenv);
 
     if (JType_ConvertPythonToJavaObject(jenv, JPy_JPyObject, globals, &objectRef, JNI_FALSE) < 0) {
         return NULL;
@@ -571,26 +761,35 @@ error:
     return NULL;
 }
 
-int copyPythonDictToJavaMap(JNIEnv *jenv, PyObject *pyDict, jobject jMap) {
+/**
+ * Copies the changes made to pyDict since pySnapshot was taken into the Java Map<String, Object> jMap.
+ * Only entries whose values are no longer the identical Python objects are converted and put,
+ * entries that were deleted are removed. Unchanged entries keep their original Java values.
+ */
+int copyPythonDictChangesToJavaMap(JNIEnv *jenv, PyObject *pyDict, PyObject *pySnapshot, jobject jMap) {
     PyObject *pyKey, *pyValue;
     Py_ssize_t pos = 0;
-    Py_ssize_t dictSize;
+    Py_ssize_t maxChanges;
+    Py_ssize_t changeCount = 0;
     jobject *jValues = NULL;
     jobject *jKeys = NULL;
-    int ii;
+    Py_ssize_t ii;
     jboolean exceptionAlready = JNI_FALSE;
     jthrowable savedException = NULL;
     int retcode = -1;
 
-    if (!PyDict_Check(pyDict)) {
+    if (!PyDict_Check(pyDict) || !PyDict_Check(pySnapshot)) {
         PyLib_ThrowUOE(jenv, "PyObject is not a dictionary!");
         return -1;
     }
 
-    dictSize = PyDict_Size(pyDict);
+    maxChanges = PyDict_Size(pyDict) + PyDict_Size(pySnapshot);
+    if (maxChanges == 0) {
+        return 0;
+    }
 
-    jKeys = malloc(dictSize * sizeof(jobject));
-    jValues = malloc(dictSize * sizeof(jobject));
+    jKeys = calloc(maxChanges, sizeof(jobject));
+    jValues = calloc(maxChanges, sizeof(jobject));
     if (jKeys == NULL || jValues == NULL) {
         PyLib_ThrowOOM(jenv);
         goto error;
@@ -603,26 +802,48 @@ int copyPythonDictToJavaMap(JNIEnv *jenv, PyObject *pyDict, jobject jMap) {
         (*jenv)->ExceptionClear(jenv);
     }
 
-    // first convert everything
-    ii = 0;
+    // first convert the changed entries, a NULL value marks a removed entry
     while (PyDict_Next(pyDict, &pos, &pyKey, &pyValue)) {
-        if (JPy_AsJObjectWithClass(jenv, pyKey, &(jKeys[ii]), JPy_String_JClass) < 0) {
+        if (PyDict_GetItem(pySnapshot, pyKey) == pyValue) {
+            continue;
+        }
+        if (JPy_AsJObjectWithClass(jenv, pyKey, &(jKeys[changeCount]), JPy_String_JClass) < 0) {
             // an error occurred
             goto error;
         }
-        if (JPy_AsJObject(jenv, pyValue, &(jValues[ii]), JNI_TRUE) < 0) {
+        if (JPy_AsJObject(jenv, pyValue, &(jValues[changeCount]), JNI_TRUE) < 0) {
+            // an error occurred
+            changeCount++;
+            goto error;
+        }
+        changeCount++;
+    }
+    pos = 0;
+    while (PyDict_Next(pySnapshot, &pos, &pyKey, &pyValue)) {
+        if (PyDict_GetItem(pyDict, pyKey) != NULL) {
+            continue;
+        }
+        if (JPy_AsJObjectWithClass(jenv, pyKey, &(jKeys[changeCount]), JPy_String_JClass) < 0) {
             // an error occurred
             goto error;
         }
-        ii++;
+        changeCount++;
     }
 
-    // now that we've converted, clear out the map and repopulate it
-    (*jenv)->CallVoidMethod(jenv, jMap, JPy_Map_clear_MID);
-    for (ii = 0; ii < dictSize; ++ii) {
-        // since the map is cleared, we want to plow through all of the put operations
-        (*jenv)->CallObjectMethod(jenv, jMap, JPy_Map_put_MID, jKeys[ii], jValues[ii]);
+    // now that we've converted, apply the changes to the map
+    for (ii = 0; ii < changeCount; ++ii) {
+        jobject jOldValue;
+        if (jValues[ii] != NULL) {
+            jOldValue = (*jenv)->CallObjectMethod(jenv, jMap, JPy_Map_put_MID, jKeys[ii], jValues[ii]);
+        } else {
+            jOldValue = (*jenv)->CallObjectMethod(jenv, jMap, JPy_Map_remove_MID, jKeys[ii]);
+        }
+        if (jOldValue != NULL) {
+            (*jenv)->DeleteLocalRef(jenv, jOldValue);
+        }
     }
+    JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "copyPythonDictChangesToJavaMap: copied %d of %d entries back\n",
+                   (int) changeCount, (int) PyDict_Size(pyDict));
     // and we are successful!
     retcode = 0;
 
@@ -632,6 +853,14 @@ error:
         (*jenv)->Throw(jenv, savedException);
     }
 
+    for (ii = 0; ii < changeCount; ++ii) {
+        if (jKeys[ii] != NULL) {
+            (*jenv)->DeleteLocalRef(jenv, jKeys[ii]);
+        }
+        if (jValues[ii] != NULL) {
+            (*jenv)->DeleteLocalRef(jenv, jValues[ii]);
+        }
+    }
     free(jKeys);
     free(jValues);
     return retcode;
@@ -651,13 +880,16 @@ typedef PyObject * (*DoRun)(const void *,int,PyObject*,PyObject*);
  *
  * jGlobals and jLocals may be a PyObject, in which case they are used without translation.  Otherwise,
  * they must be a map from String to Object, and will be copied to a new python dictionary.  After execution
- * completes the dictionary entries will be copied back.
+ * completes the dictionary entries that were changed or deleted will be copied back, by comparing the
+ * dictionary with a shallow snapshot taken before execution.
  *
  */
 jlong executeInternal(JNIEnv* jenv, jclass jLibClass, jint jStart, jobject jGlobals, jobject jLocals, DoRun runFunction, void *runArg) {
     PyObject *pyReturnValue;
     PyObject *pyGlobals;
     PyObject *pyLocals;
+    PyObject *pyGlobalsSnapshot;
+    PyObject *pyLocalsSnapshot;
     int start;
     jboolean decGlobals, decLocals, copyGlobals, copyLocals;
 
@@ -667,11 +899,13 @@ jlong executeInternal(JNIEnv* jenv, jclass jLibClass, jint jStart, jobject jGlob
     copyGlobals = copyLocals = JNI_FALSE;
     pyGlobals = NULL;
     pyLocals = NULL;
+    pyGlobalsSnapshot = NULL;
+    pyLocalsSnapshot = NULL;
     pyReturnValue = NULL;
 
     if (jGlobals == NULL) {
         JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "Java_org_jpy_PyLib_executeInternal: using main globals\n");
-        pyGlobals = getMainGlobals();
+        pyGlobals = getMainGlobals(jenv);
         if (pyGlobals == NULL) {
             PyLib_HandlePythonException(jenv);
             goto error;
@@ -679,10 +913,18 @@ jlong executeInternal(JNIEnv* jenv, jclass jLibClass, jint jStart, jobject jGlob
     } else if ((*jenv)->IsInstanceOf(jenv, jGlobals, JPy_PyObject_JClass)) {
         // if we are an instance of PyObject, just use the object
         pyGlobals = (PyObject *)((*jenv)->CallLongMethod(jenv, jGlobals, JPy_PyObject_GetPointer_MID));
+        if ((*jenv)->ExceptionCheck(jenv)) {
+            // e.g. the PyObject has been closed
+            goto error;
+        }
         JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "Java_org_jpy_PyLib_executeInternal: using PyObject globals\n");
     } else if ((*jenv)->IsInstanceOf(jenv, jGlobals, JPy_PyDictWrapper_JClass)) {
         // if we are an instance of a wrapped dictionary, just use the underlying dictionary
         pyGlobals = (PyObject *)((*jenv)->CallLongMethod(jenv, jGlobals, JPy_PyDictWrapper_GetPointer_MID));
+        if ((*jenv)->ExceptionCheck(jenv)) {
+            // e.g. the PyObject has been closed
+            goto error;
+        }
         JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "Java_org_jpy_PyLib_executeInternal: using PyDictWrapper globals\n");
     } else if ((*jenv)->IsInstanceOf(jenv, jGlobals, JPy_Map_JClass)) {
         JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "Java_org_jpy_PyLib_executeInternal: using Java Map globals\n");
@@ -692,7 +934,13 @@ jlong executeInternal(JNIEnv* jenv, jclass jLibClass, jint jStart, jobject jGlob
             PyLib_ThrowRTE(jenv, "Could not convert globals from Java Map to Python dictionary");
             goto error;
         }
-        copyGlobals = decGlobals = JNI_TRUE;
+        decGlobals = JNI_TRUE;
+        pyGlobalsSnapshot = PyDict_Copy(pyGlobals);
+        if (pyGlobalsSnapshot == NULL) {
+            PyLib_HandlePythonException(jenv);
+            goto error;
+        }
+        copyGlobals = JNI_TRUE;
     } else {
         PyLib_ThrowUOE(jenv, "Unsupported globals type");
         goto error;
@@ -710,9 +958,17 @@ jlong executeInternal(JNIEnv* jenv, jclass jLibClass, jint jStart, jobject jGlob
         // if we are an instance of PyObject, just use the object
         JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "Java_org_jpy_PyLib_executeInternal: using PyObject locals\n");
         pyLocals = (PyObject *)((*jenv)->CallLongMethod(jenv, jLocals, JPy_PyObject_GetPointer_MID));
+        if ((*jenv)->ExceptionCheck(jenv)) {
+            // e.g. the PyObject has been closed
+            goto error;
+        }
     } else if ((*jenv)->IsInstanceOf(jenv, jLocals, JPy_PyDictWrapper_JClass)) {
         // if we are an instance of a wrapped dictionary, just use the underlying dictionary
         pyLocals = (PyObject *)((*jenv)->CallLongMethod(jenv, jLocals, JPy_PyDictWrapper_GetPointer_MID));
+        if ((*jenv)->ExceptionCheck(jenv)) {
+            // e.g. the PyObject has been closed
+            goto error;
+        }
         JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "Java_org_jpy_PyLib_executeInternal: using PyDictWrapper locals\n");
     } else if ((*jenv)->IsInstanceOf(jenv, jLocals, JPy_Map_JClass)) {
         JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "Java_org_jpy_PyLib_executeInternal: using Java Map locals\n");
@@ -722,7 +978,13 @@ jlong executeInternal(JNIEnv* jenv, jclass jLibClass, jint jStart, jobject jGlob
             PyLib_ThrowRTE(jenv, "Could not convert locals from Java Map to Python dictionary");
             goto error;
         }
-        copyLocals = decLocals = JNI_TRUE;
+        decLocals = JNI_TRUE;
+        pyLocalsSnapshot = PyDict_Copy(pyLocals);
+        if (pyLocalsSnapshot == NULL) {
+            PyLib_HandlePythonException(jenv);
+            goto error;
+        }
+        copyLocals = JNI_TRUE;
     } else {
         PyLib_ThrowUOE(jenv, "Unsupported locals type");
         goto error;
@@ -741,13 +1003,15 @@ jlong executeInternal(JNIEnv* jenv, jclass jLibClass, jint jStart, jobject jGlob
 
 error:
     if (copyGlobals) {
-        copyPythonDictToJavaMap(jenv, pyGlobals, jGlobals);
+        copyPythonDictChangesToJavaMap(jenv, pyGlobals, pyGlobalsSnapshot, jGlobals);
         JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "Java_org_jpy_PyLib_executeInternal: copied back Java global\n");
     }
     if (copyLocals) {
-        copyPythonDictToJavaMap(jenv, pyLocals, jLocals);
+        copyPythonDictChangesToJavaMap(jenv, pyLocals, pyLocalsSnapshot, jLocals);
         JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "Java_org_jpy_PyLib_executeInternal: copied back Java locals\n");
     }
+    Py_XDECREF(pyGlobalsSnapshot);
+    Py_XDECREF(pyLocalsSnapshot);
     if (decGlobals) {
         Py_XDECREF(pyGlobals);
     }
@@ -777,7 +1041,8 @@ PyObject *pyRunStringWrapper(const char *code, int start, PyObject *globals, PyO
  *
  * jGlobals and jLocals may be a PyObject, in which case they are used without translation.  Otherwise,
  * they must be a map from String to Object, and will be copied to a new python dictionary.  After execution
- * completes the dictionary entries will be copied back.
+ * completes the dictionary entries that were changed or deleted will be copied back, by comparing the
+ * dictionary with a shallow snapshot taken before execution.
  */
 JNIEXPORT
 jlong JNICALL Java_org_jpy_PyLib_executeCode
@@ -823,7 +1088,8 @@ PyObject *pyRunFileWrapper(RunFileArgs *args, int start, PyObject *globals, PyOb
  *
  * jGlobals and jLocals may be a PyObject, in which case they are used without translation.  Otherwise,
  * they must be a map from String to Object, and will be copied to a new python dictionary.  After execution
- * completes the dictionary entries will be copied back.
+ * completes the dictionary entries that were changed or deleted will be copied back, by comparing the
+ * dictionary with a shallow snapshot taken before execution.
  */
 JNIEXPORT jlong JNICALL Java_org_jpy_PyLib_executeScript
         (JNIEnv* jenv, jclass jLibClass, jstring jFile, jint jStart, jobject jGlobals, jobject jLocals) {
@@ -857,6 +1123,71 @@ error:
     return result;
 }
 
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    compileCode
+ * Signature: (Ljava/lang/String;I)J
+ */
+JNIEXPORT jlong JNICALL Java_org_jpy_PyLib_compileCode
+  (JNIEnv* jenv, jclass jLibClass, jstring jCode, jint jStart)
+{
+    const char* codeChars;
+    PyObject* pyCode;
+    int start;
+
+    codeChars = (*jenv)->GetStringUTFChars(jenv, jCode, NULL);
+    if (codeChars == NULL) {
+        PyLib_ThrowOOM(jenv);
+        return 0;
+    }
+
+    JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "Java_org_jpy_PyLib_compileCode: code='%s'\n", codeChars);
+
+    start = jStart == JPy_IM_STATEMENT ? Py_single_input :
+            jStart == JPy_IM_SCRIPT ? Py_file_input :
+            Py_eval_input;
+
+    JPy_BEGIN_GIL_STATE
+
+    // Note: pyCode is a new reference
+    pyCode = Py_CompileString(codeChars, "<string>", start);
+    if (pyCode == NULL) {
+        PyLib_HandlePythonException(jenv);
+    }
+
+    JPy_END_GIL_STATE
+
+    (*jenv)->ReleaseStringUTFChars(jenv, jCode, codeChars);
+
+    return (jlong) pyCode;
+}
+
+PyObject *pyEvalCodeWrapper(PyObject *code, int start, PyObject *globals, PyObject *locals) {
+    // PyEval_EvalCode() doesn't check its argument, and executeCompiled() accepts any PyObject
+    if (!PyCode_Check(code)) {
+        PyErr_Format(PyExc_TypeError, "expected a code object, got '%s'", Py_TYPE(code)->tp_name);
+        return NULL;
+    }
+#if defined(JPY_COMPAT_33P)
+    return PyEval_EvalCode(code, globals, locals);
+#else
+    return PyEval_EvalCode((PyCodeObject*) code, globals, locals);
+#endif
+}
+
+/**
+ * Calls PyEval_EvalCode under the covers to execute a code object compiled by compileCode().
+ * The handling of jGlobals and jLocals is the same as for executeCode().
+ */
+JNIEXPORT jlong JNICALL Java_org_jpy_PyLib_executeCompiledCode
+  (JNIEnv* jenv, jclass jLibClass, jlong codeId, jobject jGlobals, jobject jLocals)
+{
+    JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "Java_org_jpy_PyLib_executeCompiledCode: code=%p\n", (PyObject*) codeId);
+
+    // The start symbol has already been applied by compileCode()
+    return executeInternal(jenv, jLibClass, JPy_IM_SCRIPT, jGlobals, jLocals, (DoRun)pyEvalCodeWrapper, (PyObject*) codeId);
+}
+
 /*
  * Class:     org_jpy_python_PyLib
  * Method:    incRef
@@ -873,7 +1204,7 @@ JNIEXPORT void JNICALL Java_org_jpy_PyLib_incRef
     if (Py_IsInitialized()) {
         JPy_BEGIN_GIL_STATE
 
-        refCount = pyObject->ob_refcnt;
+        refCount = Py_REFCNT(pyObject);
         JPy_DIAG_PRINT(JPy_DIAG_F_MEM, "Java_org_jpy_PyLib_incRef: pyObject=%p, refCount=%d, type='%s'\n", pyObject, refCount, Py_TYPE(pyObject)->tp_name);
         Py_INCREF(pyObject);
 
@@ -899,7 +1230,7 @@ JNIEXPORT void JNICALL Java_org_jpy_PyLib_decRef
     if (Py_IsInitialized()) {
         JPy_BEGIN_GIL_STATE
 
-        refCount = pyObject->ob_refcnt;
+        refCount = Py_REFCNT(pyObject);
         if (refCount <= 0) {
             JPy_DIAG_PRINT(JPy_DIAG_F_ALL, "Java_org_jpy_PyLib_decRef: error: refCount <= 0: pyObject=%p, refCount=%d\n", pyObject, refCount);
         } else {
@@ -913,6 +1244,75 @@ JNIEXPORT void JNICALL Java_org_jpy_PyLib_decRef
     }
 }
 
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    decRefs
+ * Signature: ([JI)V
+ */
+JNIEXPORT void JNICALL Java_org_jpy_PyLib_decRefs
+  (JNIEnv* jenv, jclass jLibClass, jlongArray jPointers, jint count)
+{
+    PyObject* pyObject;
+    jlong* pointers;
+    jint i;
+
+    if (!Py_IsInitialized()) {
+        JPy_DIAG_PRINT(JPy_DIAG_F_ALL, "Java_org_jpy_PyLib_decRefs: error: no interpreter: count=%d\n", count);
+        return;
+    }
+
+    pointers = (*jenv)->GetLongArrayElements(jenv, jPointers, NULL);
+    if (pointers == NULL) {
+        PyLib_ThrowOOM(jenv);
+        return;
+    }
+
+    JPy_BEGIN_GIL_STATE
+
+    JPy_DIAG_PRINT(JPy_DIAG_F_MEM, "Java_org_jpy_PyLib_decRefs: count=%d\n", count);
+
+    for (i = 0; i < count; i++) {
+        pyObject = (PyObject*) pointers[i];
+        if (Py_REFCNT(pyObject) <= 0) {
+            JPy_DIAG_PRINT(JPy_DIAG_F_ALL, "Java_org_jpy_PyLib_decRefs: error: refCount <= 0: pyObject=%p, refCount=%d\n", pyObject, Py_REFCNT(pyObject));
+        } else {
+            Py_DECREF(pyObject);
+        }
+    }
+
+    JPy_END_GIL_STATE
+
+    (*jenv)->ReleaseLongArrayElements(jenv, jPointers, pointers, JNI_ABORT);
+}
+
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    formatException
+ * Signature: (JJ)Ljava/lang/String;
+ */
+JNIEXPORT jstring JNICALL Java_org_jpy_PyLib_formatException
+  (JNIEnv* jenv, jclass jLibClass, jlong valueId, jlong tracebackId)
+{
+    PyObject* pyValue;
+    char* message;
+    jstring jMessage = NULL;
+
+    JPy_BEGIN_GIL_STATE
+
+    pyValue = (PyObject*) valueId;
+    message = PyLib_FormatPythonException((PyObject*) Py_TYPE(pyValue), pyValue, (PyObject*) tracebackId);
+    if (message != NULL) {
+        jMessage = (*jenv)->NewStringUTF(jenv, message);
+        PyMem_Del(message);
+    }
+    // Errors while formatting only make parts of the message unavailable
+    PyErr_Clear();
+
+    JPy_END_GIL_STATE
+
+    return jMessage;
+}
 
 /*
  * Class:     org_jpy_python_PyLib
@@ -1736,79 +2136,626 @@ error:
 }
 
 
-/*
- * Class:     org_jpy_python_PyLib
- * Method:    getDiagFlags
- * Signature: ()I
+/**
+ * Parameter types resolved once for calls through an org.jpy.PyCallable, so that calls don't need to
+ * look up the JPy_JType of each parameter class again. 'types' has 'count' entries, NULL entries mean
+ * that the type is derived from the argument value.
  */
-JNIEXPORT jint JNICALL Java_org_jpy_PyLib_00024Diag_getFlags
-  (JNIEnv *jenv, jclass classRef)
+typedef struct PyLib_ParamTypes
 {
-    return JPy_DiagFlags;
+    jint count;
+    JPy_JType** types;
 }
+PyLib_ParamTypes;
 
 /*
- * Class:     org_jpy_python_PyLib
- * Method:    setDiagFlags
- * Signature: (I)V
+ * Class:     org_jpy_PyLib
+ * Method:    resolveParamTypes
+ * Signature: ([Ljava/lang/Class;)J
  */
-JNIEXPORT void JNICALL Java_org_jpy_PyLib_00024Diag_setFlags
-  (JNIEnv *jenv, jclass classRef, jint flags)
+JNIEXPORT jlong JNICALL Java_org_jpy_PyLib_resolveParamTypes
+  (JNIEnv *jenv, jclass jLibClass, jobjectArray jParamClasses)
 {
-    JPy_DiagFlags = flags;
-}
-
-////////////////////////////////////////////////////////////////////////////////////
-// Helpers that also throw Java exceptions
+    PyLib_ParamTypes* paramTypes;
+    JPy_JType* paramType;
+    jclass jParamClass;
+    jint paramCount;
+    jint i;
 
+    paramCount = (*jenv)->GetArrayLength(jenv, jParamClasses);
 
-PyObject* PyLib_GetAttributeObject(JNIEnv* jenv, PyObject* pyObject, jstring jName)
-{
-    PyObject* pyValue = NULL;
-    const char* nameChars;
+    JPy_BEGIN_GIL_STATE
 
-    nameChars = (*jenv)->GetStringUTFChars(jenv, jName, NULL);
-    if (nameChars == NULL) {
+    // A single allocation holds both the header and the types
+    paramTypes = (PyLib_ParamTypes*) PyMem_Malloc(sizeof (PyLib_ParamTypes) + paramCount * sizeof (JPy_JType*));
+    if (paramTypes == NULL) {
         PyLib_ThrowOOM(jenv);
         goto error;
     }
-    JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "PyLib_GetAttributeObject: objId=%p, name='%s'\n", pyObject, nameChars);
-    /* Note: pyValue is a new reference */
-    pyValue = PyObject_GetAttrString(pyObject, nameChars);
-    if (pyValue == NULL) {
-        JPy_DIAG_PRINT(JPy_DIAG_F_ALL, "PyLib_GetAttributeObject: error: attribute not found '%s'\n", nameChars);
-        PyLib_HandlePythonException(jenv);
-    }
-error:
-    if (nameChars != NULL) {
-        (*jenv)->ReleaseStringUTFChars(jenv, jName, nameChars);
+    paramTypes->count = paramCount;
+    paramTypes->types = (JPy_JType**) (paramTypes + 1);
+
+    for (i = 0; i < paramCount; i++) {
+        jParamClass = (*jenv)->GetObjectArrayElement(jenv, jParamClasses, i);
+        if (jParamClass != NULL) {
+            paramType = JType_GetType(jenv, jParamClass, JNI_FALSE);
+            (*jenv)->DeleteLocalRef(jenv, jParamClass);
+            if (paramType == NULL) {
+                JPy_DIAG_PRINT(JPy_DIAG_F_ALL, "Java_org_jpy_PyLib_resolveParamTypes: error: parameter %d: failed to retrieve type\n", i);
+                PyLib_HandlePythonException(jenv);
+                paramTypes->count = i;
+                Java_org_jpy_PyLib_releaseParamTypes(jenv, jLibClass, (jlong) paramTypes);
+                paramTypes = NULL;
+                goto error;
+            }
+            // The new reference returned by JType_GetType() is released by releaseParamTypes()
+        } else {
+            paramType = NULL;
+        }
+        paramTypes->types[i] = paramType;
     }
-    return pyValue;
-}
 
-PyObject* PyLib_CallAndReturnObject(JNIEnv *jenv, PyObject* pyObject, jboolean isMethodCall, jstring jName, jint argCount, jobjectArray jArgs, jobjectArray jParamClasses)
+error:
+    JPy_END_GIL_STATE
+
+    return (jlong) paramTypes;
+}
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    releaseParamTypes
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_org_jpy_PyLib_releaseParamTypes
+  (JNIEnv *jenv, jclass jLibClass, jlong paramTypesId)
 {
-    PyObject* pyCallable = NULL;
-    PyObject* pyArgs = NULL;
+    PyLib_ParamTypes* paramTypes;
+    jint i;
+
+    paramTypes = (PyLib_ParamTypes*) paramTypesId;
+    if (paramTypes == NULL || !Py_IsInitialized()) {
+        return;
+    }
+
+    JPy_BEGIN_GIL_STATE
+
+    for (i = 0; i < paramTypes->count; i++) {
+        Py_XDECREF(paramTypes->types[i]);
+    }
+    PyMem_Free(paramTypes);
+
+    JPy_END_GIL_STATE
+}
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    callObject
+ * Signature: (JI[Ljava/lang/Object;J)J
+ */
+JNIEXPORT jlong JNICALL Java_org_jpy_PyLib_callObject
+  (JNIEnv *jenv, jclass jLibClass, jlong objId, jint argCount, jobjectArray jArgs, jlong paramTypesId)
+{
+    PyObject* pyCallable;
+    PyObject* pyReturnValue;
+    PyLib_ParamTypes* paramTypes;
+
+    JPy_BEGIN_GIL_STATE
+
+    pyCallable = (PyObject*) objId;
+    paramTypes = (PyLib_ParamTypes*) paramTypesId;
+
+    JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "Java_org_jpy_PyLib_callObject: objId=%p, argCount=%d\n", pyCallable, argCount);
+
+    pyReturnValue = PyLib_CallCallable(jenv, pyCallable, "<callable>", argCount, jArgs, NULL, paramTypes != NULL ? paramTypes->types : NULL);
+
+    JPy_END_GIL_STATE
+
+    return (jlong) pyReturnValue;
+}
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    callObjectAndReturnValue
+ * Signature: (JI[Ljava/lang/Object;JLjava/lang/Class;)Ljava/lang/Object;
+ */
+JNIEXPORT jobject JNICALL Java_org_jpy_PyLib_callObjectAndReturnValue
+  (JNIEnv *jenv, jclass jLibClass, jlong objId, jint argCount, jobjectArray jArgs, jlong paramTypesId, jclass jReturnClass)
+{
+    PyObject* pyCallable;
+    PyObject* pyReturnValue;
+    PyLib_ParamTypes* paramTypes;
+    jobject jReturnValue;
+
+    JPy_BEGIN_GIL_STATE
+
+    pyCallable = (PyObject*) objId;
+    paramTypes = (PyLib_ParamTypes*) paramTypesId;
+    jReturnValue = NULL;
+
+    pyReturnValue = PyLib_CallCallable(jenv, pyCallable, "<callable>", argCount, jArgs, NULL, paramTypes != NULL ? paramTypes->types : NULL);
+    if (pyReturnValue == NULL) {
+        goto error;
+    }
+
+    if (JPy_AsJObjectWithClass(jenv, pyReturnValue, &jReturnValue, jReturnClass) < 0) {
+        JPy_DIAG_PRINT(JPy_DIAG_F_ALL, "Java_org_jpy_PyLib_callObjectAndReturnValue: error: failed to convert return value\n");
+        PyLib_HandlePythonException(jenv);
+        jReturnValue = NULL;
+    }
+    Py_DECREF(pyReturnValue);
+
+error:
+    JPy_END_GIL_STATE
+
+    return jReturnValue;
+}
+
+
+/**
+ * Calls the Python callable with up to 4 primitive arguments, without any Java objects involved.
+ * Bit i of 'doubleArgs' is set if argument i is a Java double, given by its raw bits
+ * (Double.doubleToRawLongBits()), otherwise argument i is a Java long.
+ * Returns a new reference to the call's result, or NULL, in which case a Java exception has been thrown.
+ */
+PyObject* PyLib_CallWithPrimitiveArgs(JNIEnv* jenv, PyObject* pyCallable, jint argCount, jint doubleArgs, const jlong* args)
+{
+    PyObject* pyArgs;
     PyObject* pyArg;
-    PyObject* pyReturnValue = Py_None;
-    const char* nameChars;
+    PyObject* pyReturnValue;
+    union { jlong j; jdouble d; } bits;
     jint i;
-    jobject jArg;
-    jclass jParamClass;
-    JPy_JType* paramType;
 
-    pyReturnValue = NULL;
+    pyArgs = PyTuple_New(argCount);
+    if (pyArgs == NULL) {
+        PyLib_HandlePythonException(jenv);
+        return NULL;
+    }
+
+    for (i = 0; i < argCount; i++) {
+        if ((doubleArgs & (1 << i)) != 0) {
+            bits.j = args[i];
+            pyArg = JPy_FROM_JDOUBLE(bits.d);
+        } else {
+            pyArg = JPy_FROM_JLONG(args[i]);
+        }
+        if (pyArg == NULL) {
+            PyLib_HandlePythonException(jenv);
+            Py_DECREF(pyArgs);
+            return NULL;
+        }
+        // pyArg reference stolen here
+        PyTuple_SET_ITEM(pyArgs, i, pyArg);
+    }
+
+    pyReturnValue = PyObject_CallObject(pyCallable, pyArgs);
+    Py_DECREF(pyArgs);
+    if (pyReturnValue == NULL) {
+        JPy_DIAG_PRINT(JPy_DIAG_F_ALL, "PyLib_CallWithPrimitiveArgs: error: call returned NULL\n");
+        PyLib_HandlePythonException(jenv);
+    }
+
+    return pyReturnValue;
+}
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    callDouble
+ * Signature: (JIIJJJJ)D
+ */
+JNIEXPORT jdouble JNICALL Java_org_jpy_PyLib_callDouble
+  (JNIEnv* jenv, jclass jLibClass, jlong objId, jint argCount, jint doubleArgs, jlong arg0, jlong arg1, jlong arg2, jlong arg3)
+{
+    PyObject* pyReturnValue;
+    jlong args[4];
+    jdouble value;
+
+    args[0] = arg0;
+    args[1] = arg1;
+    args[2] = arg2;
+    args[3] = arg3;
+    value = 0.0;
+
+    JPy_BEGIN_GIL_STATE
+
+    pyReturnValue = PyLib_CallWithPrimitiveArgs(jenv, (PyObject*) objId, argCount, doubleArgs, args);
+    if (pyReturnValue != NULL) {
+        value = JPy_AS_JDOUBLE(pyReturnValue);
+        if (value == -1.0 && PyErr_Occurred()) {
+            PyLib_HandlePythonException(jenv);
+        }
+        Py_DECREF(pyReturnValue);
+    }
+
+    JPy_END_GIL_STATE
+
+    return value;
+}
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    callLong
+ * Signature: (JIIJJJJ)J
+ */
+JNIEXPORT jlong JNICALL Java_org_jpy_PyLib_callLong
+  (JNIEnv* jenv, jclass jLibClass, jlong objId, jint argCount, jint doubleArgs, jlong arg0, jlong arg1, jlong arg2, jlong arg3)
+{
+    PyObject* pyReturnValue;
+    jlong args[4];
+    jlong value;
+
+    args[0] = arg0;
+    args[1] = arg1;
+    args[2] = arg2;
+    args[3] = arg3;
+    value = 0;
+
+    JPy_BEGIN_GIL_STATE
+
+    pyReturnValue = PyLib_CallWithPrimitiveArgs(jenv, (PyObject*) objId, argCount, doubleArgs, args);
+    if (pyReturnValue != NULL) {
+        value = JPy_AS_JLONG(pyReturnValue);
+        if (value == -1 && PyErr_Occurred()) {
+            PyLib_HandlePythonException(jenv);
+        }
+        Py_DECREF(pyReturnValue);
+    }
+
+    JPy_END_GIL_STATE
+
+    return value;
+}
+
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    getLength
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_org_jpy_PyLib_getLength
+  (JNIEnv* jenv, jclass jLibClass, jlong objId)
+{
+    Py_ssize_t length;
+
+    JPy_BEGIN_GIL_STATE
+
+    length = PyObject_Length((PyObject*) objId);
+    if (length < 0) {
+        PyLib_HandlePythonException(jenv);
+    }
+
+    JPy_END_GIL_STATE
+
+    return length > JPy_MAX_ARRAY_LENGTH ? JPy_MAX_ARRAY_LENGTH : (jint) length;
+}
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    listGetItem
+ * Signature: (JI)J
+ */
+JNIEXPORT jlong JNICALL Java_org_jpy_PyLib_listGetItem
+  (JNIEnv* jenv, jclass jLibClass, jlong objId, jint index)
+{
+    PyObject* pyList;
+    PyObject* pyItem;
+
+    JPy_BEGIN_GIL_STATE
+
+    pyList = (PyObject*) objId;
+    if (index < 0 || index >= PyList_Size(pyList)) {
+        PyLib_ThrowIOOBE(jenv, index);
+        pyItem = NULL;
+    } else {
+        // Note: PyList_GET_ITEM returns a borrowed reference
+        pyItem = PyList_GET_ITEM(pyList, index);
+        Py_INCREF(pyItem);
+    }
+
+    JPy_END_GIL_STATE
+
+    return (jlong) pyItem;
+}
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    listGetItems
+ * Signature: (JII)[J
+ */
+JNIEXPORT jlongArray JNICALL Java_org_jpy_PyLib_listGetItems
+  (JNIEnv* jenv, jclass jLibClass, jlong objId, jint index, jint count)
+{
+    PyObject* pyList;
+    PyObject* pyItem;
+    jlongArray jPointers;
+    jlong* pointers;
+    jint i;
+
+    jPointers = NULL;
+
+    JPy_BEGIN_GIL_STATE
+
+    pyList = (PyObject*) objId;
+    if (index < 0 || count < 0 || index > PyList_Size(pyList) - count) {
+        PyLib_ThrowIOOBE(jenv, index + count);
+        goto error;
+    }
+
+    jPointers = (*jenv)->NewLongArray(jenv, count);
+    if (jPointers == NULL) {
+        goto error;
+    }
+    pointers = (*jenv)->GetLongArrayElements(jenv, jPointers, NULL);
+    if (pointers == NULL) {
+        PyLib_ThrowOOM(jenv);
+        jPointers = NULL;
+        goto error;
+    }
+    for (i = 0; i < count; i++) {
+        pyItem = PyList_GET_ITEM(pyList, index + i);
+        Py_INCREF(pyItem);
+        pointers[i] = (jlong) pyItem;
+    }
+    (*jenv)->ReleaseLongArrayElements(jenv, jPointers, pointers, 0);
+
+error:
+    JPy_END_GIL_STATE
+
+    return jPointers;
+}
+
+/**
+ * Converts a Java dictionary key into a new reference to a Python object.
+ * Unlike JPy_FromJObject(), this also returns a new reference for a wrapped Python object (org.jpy.PyObject).
+ */
+PyObject* PyLib_NewKeyObject(JNIEnv* jenv, jobject jKey)
+{
+    PyObject* pyKey;
+
+    if (jKey != NULL && (*jenv)->IsInstanceOf(jenv, jKey, JPy_JPyObject->classRef)) {
+        pyKey = (PyObject*) (*jenv)->CallLongMethod(jenv, jKey, JPy_PyObject_GetPointer_MID);
+        if ((*jenv)->ExceptionCheck(jenv)) {
+            // e.g. closed, the Java exception is passed on
+            return NULL;
+        }
+        Py_XINCREF(pyKey);
+    } else {
+        pyKey = JPy_FromJObject(jenv, jKey);
+    }
+    if (pyKey == NULL) {
+        PyLib_HandlePythonException(jenv);
+    }
+    return pyKey;
+}
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    dictGetItem
+ * Signature: (JLjava/lang/Object;)J
+ */
+JNIEXPORT jlong JNICALL Java_org_jpy_PyLib_dictGetItem
+  (JNIEnv* jenv, jclass jLibClass, jlong objId, jobject jKey)
+{
+    PyObject* pyKey;
+    PyObject* pyValue;
+
+    pyValue = NULL;
+
+    JPy_BEGIN_GIL_STATE
+
+    pyKey = PyLib_NewKeyObject(jenv, jKey);
+    if (pyKey != NULL) {
+        // Note: missing keys set no exception, errors such as unhashable keys do
+#if defined(JPY_FREE_THREADED)
+        if (PyDict_GetItemRef((PyObject*) objId, pyKey, &pyValue) < 0) {
+            PyLib_HandlePythonException(jenv);
+        }
+#elif defined(JPY_COMPAT_33P)
+        // Note: pyValue is a borrowed reference
+        pyValue = PyDict_GetItemWithError((PyObject*) objId, pyKey);
+        if (pyValue != NULL) {
+            Py_INCREF(pyValue);
+        } else if (PyErr_Occurred()) {
+            PyLib_HandlePythonException(jenv);
+        }
+#else
+        // Note: pyValue is a borrowed reference, Python 2.7 has no PyDict_GetItemWithError()
+        pyValue = PyDict_GetItem((PyObject*) objId, pyKey);
+        Py_XINCREF(pyValue);
+#endif
+        Py_DECREF(pyKey);
+    }
+
+    JPy_END_GIL_STATE
+
+    return (jlong) pyValue;
+}
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    dictContainsKey
+ * Signature: (JLjava/lang/Object;)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_jpy_PyLib_dictContainsKey
+  (JNIEnv* jenv, jclass jLibClass, jlong objId, jobject jKey)
+{
+    PyObject* pyKey;
+    int result;
+
+    result = 0;
+
+    JPy_BEGIN_GIL_STATE
+
+    pyKey = PyLib_NewKeyObject(jenv, jKey);
+    if (pyKey != NULL) {
+        result = PyDict_Contains((PyObject*) objId, pyKey);
+        if (result < 0) {
+            PyLib_HandlePythonException(jenv);
+        }
+        Py_DECREF(pyKey);
+    }
+
+    JPy_END_GIL_STATE
+
+    return result > 0;
+}
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    dictNext
+ * Signature: (JJ[J)J
+ */
+JNIEXPORT jlong JNICALL Java_org_jpy_PyLib_dictNext
+  (JNIEnv* jenv, jclass jLibClass, jlong objId, jlong pos, jlongArray jKeyValue)
+{
+    PyObject* pyKey;
+    PyObject* pyValue;
+    Py_ssize_t ppos;
+    jlong keyValue[2];
+    jint length;
+
+    ppos = (Py_ssize_t) pos;
+    // If 'jKeyValue' has only one element, just the key is returned
+    length = (*jenv)->GetArrayLength(jenv, jKeyValue) < 2 ? 1 : 2;
+
+    JPy_BEGIN_GIL_STATE
+
+    // Note: pyKey and pyValue are borrowed references
+    if (PyDict_Next((PyObject*) objId, &ppos, &pyKey, &pyValue)) {
+        Py_INCREF(pyKey);
+        keyValue[0] = (jlong) pyKey;
+        if (length == 2) {
+            Py_INCREF(pyValue);
+            keyValue[1] = (jlong) pyValue;
+        }
+        (*jenv)->SetLongArrayRegion(jenv, jKeyValue, 0, length, keyValue);
+    } else {
+        ppos = -1;
+    }
+
+    JPy_END_GIL_STATE
+
+    return (jlong) ppos;
+}
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    dictGetItems
+ * Signature: (J)[J
+ */
+JNIEXPORT jlongArray JNICALL Java_org_jpy_PyLib_dictGetItems
+  (JNIEnv* jenv, jclass jLibClass, jlong objId)
+{
+    PyObject* pyDict;
+    PyObject* pyKey;
+    PyObject* pyValue;
+    Py_ssize_t ppos;
+    Py_ssize_t size;
+    jlongArray jPointers;
+    jlong* pointers;
+    jint i;
+
+    jPointers = NULL;
+
+    JPy_BEGIN_GIL_STATE
+
+    pyDict = (PyObject*) objId;
+    size = PyDict_Size(pyDict);
+    if (size > JPy_MAX_ARRAY_LENGTH / 2) {
+        PyLib_ThrowUOE(jenv, "dictionary too large");
+        goto error;
+    }
+
+    jPointers = (*jenv)->NewLongArray(jenv, (jint) (2 * size));
+    if (jPointers == NULL) {
+        goto error;
+    }
+    pointers = (*jenv)->GetLongArrayElements(jenv, jPointers, NULL);
+    if (pointers == NULL) {
+        PyLib_ThrowOOM(jenv);
+        jPointers = NULL;
+        goto error;
+    }
+    // No Python code runs in between, so the dictionary can't change its size
+    ppos = 0;
+    i = 0;
+    while (PyDict_Next(pyDict, &ppos, &pyKey, &pyValue)) {
+        Py_INCREF(pyKey);
+        Py_INCREF(pyValue);
+        pointers[i++] = (jlong) pyKey;
+        pointers[i++] = (jlong) pyValue;
+    }
+    (*jenv)->ReleaseLongArrayElements(jenv, jPointers, pointers, 0);
+
+error:
+    JPy_END_GIL_STATE
+
+    return jPointers;
+}
+
+
+/*
+ * Class:     org_jpy_python_PyLib
+ * Method:    getDiagFlags
+ * Signature: ()I
+ */
+JNIEXPORT jint JNICALL Java_org_jpy_PyLib_00024Diag_getFlags
+  (JNIEnv *jenv, jclass classRef)
+{
+    return JPy_DiagFlags;
+}
+
+/*
+ * Class:     org_jpy_python_PyLib
+ * Method:    setDiagFlags
+ * Signature: (I)V
+ */
+JNIEXPORT void JNICALL Java_org_jpy_PyLib_00024Diag_setFlags
+  (JNIEnv *jenv, jclass classRef, jint flags)
+{
+    JPy_DiagFlags = flags;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+// Helpers that also throw Java exceptions
+
+
+PyObject* PyLib_GetAttributeObject(JNIEnv* jenv, PyObject* pyObject, jstring jName)
+{
+    PyObject* pyValue = NULL;
+    const char* nameChars;
 
     nameChars = (*jenv)->GetStringUTFChars(jenv, jName, NULL);
     if (nameChars == NULL) {
         PyLib_ThrowOOM(jenv);
         goto error;
     }
+    JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "PyLib_GetAttributeObject: objId=%p, name='%s'\n", pyObject, nameChars);
+    /* Note: pyValue is a new reference */
+    pyValue = PyObject_GetAttrString(pyObject, nameChars);
+    if (pyValue == NULL) {
+        JPy_DIAG_PRINT(JPy_DIAG_F_ALL, "PyLib_GetAttributeObject: error: attribute not found '%s'\n", nameChars);
+        PyLib_HandlePythonException(jenv);
+    }
+error:
+    if (nameChars != NULL) {
+        (*jenv)->ReleaseStringUTFChars(jenv, jName, nameChars);
+    }
+    return pyValue;
+}
 
-    JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "PyLib_CallAndReturnObject: objId=%p, isMethodCall=%d, name='%s', argCount=%d\n", pyObject, isMethodCall, nameChars, argCount);
+PyObject* PyLib_CallAndReturnObject(JNIEnv *jenv, PyObject* pyObject, jboolean isMethodCall, jstring jName, jint argCount, jobjectArray jArgs, jobjectArray jParamClasses)
+{
+    PyObject* pyCallable = NULL;
+    PyObject* pyReturnValue = NULL;
+    const char* nameChars;
+
+    nameChars = (*jenv)->GetStringUTFChars(jenv, jName, NULL);
+    if (nameChars == NULL) {
+        PyLib_ThrowOOM(jenv);
+        goto error;
+    }
 
-    pyArgs = NULL;
+    JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "PyLib_CallAndReturnObject: objId=%p, isMethodCall=%d, name='%s', argCount=%d\n", pyObject, isMethodCall, nameChars, argCount);
 
     // Note: pyCallable is a new reference
     pyCallable = PyObject_GetAttrString(pyObject, nameChars);
@@ -1824,23 +2771,84 @@ PyObject* PyLib_CallAndReturnObject(JNIEnv *jenv, PyObject* pyObject, jboolean i
         goto error;
     }
 
+    // Check why: for some reason, we don't need the following code to invoke object methods.
+    /*
+    if (isMethodCall) {
+        PyObject* pyMethod;
+
+        pyMethod = PyMethod_New(pyCallable, pyObject);
+        if (pyMethod == NULL) {
+            JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "PyLib_CallAndReturnObject: error: callable '%s': no memory\n", nameChars);
+            PyLib_HandlePythonException(jenv);
+            goto error;
+        }
+        Py_DECREF(pyCallable);
+        pyCallable = pyMethod;
+    }
+    */
+
+    pyReturnValue = PyLib_CallCallable(jenv, pyCallable, nameChars, argCount, jArgs, jParamClasses, NULL);
+    if (pyReturnValue == NULL) {
+        goto error;
+    }
+
+    Py_INCREF(pyReturnValue);
+
+error:
+    if (nameChars != NULL) {
+        (*jenv)->ReleaseStringUTFChars(jenv, jName, nameChars);
+    }
+    Py_XDECREF(pyCallable);
+
+    return pyReturnValue;
+}
+
+/**
+ * Converts the Java arguments into a new Python tuple. The parameter types used for the conversion are either
+ * given by the already resolved 'paramTypes' (an array of 'argCount' types, see resolveParamTypes()),
+ * or by the Java classes in 'jParamClasses'. If neither gives a type, it is derived from the argument value.
+ * 'nameChars' is only used for diagnostics.
+ */
+PyObject* PyLib_NewArgsTuple(JNIEnv *jenv, const char* nameChars, jint argCount, jobjectArray jArgs, jobjectArray jParamClasses, JPy_JType** paramTypes)
+{
+    PyObject* pyArgs;
+    PyObject* pyArg;
+    jint i;
+    jobject jArg;
+    jclass jParamClass;
+    JPy_JType* paramType;
+
     pyArgs = PyTuple_New(argCount);
+    if (pyArgs == NULL) {
+        PyLib_HandlePythonException(jenv);
+        return NULL;
+    }
+
     for (i = 0; i < argCount; i++) {
         jArg = (*jenv)->GetObjectArrayElement(jenv, jArgs, i);
 
-        if (jParamClasses != NULL) {
+        if (paramTypes != NULL) {
+            paramType = paramTypes[i];
+        } else if (jParamClasses != NULL) {
             jParamClass = (*jenv)->GetObjectArrayElement(jenv, jParamClasses, i);
+            if (jParamClass != NULL) {
+                paramType = JType_GetType(jenv, jParamClass, JNI_FALSE);
+                (*jenv)->DeleteLocalRef(jenv, jParamClass);
+                if (paramType == NULL) {
+                    JPy_DIAG_PRINT(JPy_DIAG_F_ALL, "PyLib_NewArgsTuple: error: callable '%s': argument %d: failed to retrieve type\n", nameChars, i);
+                    PyLib_HandlePythonException(jenv);
+                    (*jenv)->DeleteLocalRef(jenv, jArg);
+                    Py_DECREF(pyArgs);
+                    return NULL;
+                }
+            } else {
+                paramType = NULL;
+            }
         } else {
-            jParamClass = NULL;
+            paramType = NULL;
         }
 
-        if (jParamClass != NULL) {
-            paramType = JType_GetType(jenv, jParamClass, JNI_FALSE);
-            if (paramType == NULL) {
-                JPy_DIAG_PRINT(JPy_DIAG_F_ALL, "PyLib_CallAndReturnObject: error: callable '%s': argument %d: failed to retrieve type\n", nameChars, i);
-                PyLib_HandlePythonException(jenv);
-                goto error;
-            }
+        if (paramType != NULL) {
             pyArg = JPy_FromJObjectWithType(jenv, jArg, paramType);
 
             // We must keep unchanged the reference counter when calling a Python method
@@ -1850,11 +2858,9 @@ PyObject* PyLib_CallAndReturnObject(JNIEnv *jenv, PyObject* pyObject, jboolean i
             // for (DataFrameColumn column : values) {
             //    kycProcessor.addColumn(dt_X, column.getName(), column.getValues());
             // }
-            if (paramType == JPy_JPyObject && paramType->componentType == NULL) {
+            if (pyArg != NULL && paramType == JPy_JPyObject && paramType->componentType == NULL) {
                 Py_INCREF(pyArg);
             } 
-
-            (*jenv)->DeleteLocalRef(jenv, jParamClass);
         } else {
             pyArg = JPy_FromJObject(jenv, jArg);
         }
@@ -1862,46 +2868,40 @@ PyObject* PyLib_CallAndReturnObject(JNIEnv *jenv, PyObject* pyObject, jboolean i
         (*jenv)->DeleteLocalRef(jenv, jArg);
 
         if (pyArg == NULL) {
-            JPy_DIAG_PRINT(JPy_DIAG_F_ALL, "PyLib_CallAndReturnObject: error: callable '%s': argument %d: failed to convert Java into Python object\n", nameChars, i);
+            JPy_DIAG_PRINT(JPy_DIAG_F_ALL, "PyLib_NewArgsTuple: error: callable '%s': argument %d: failed to convert Java into Python object\n", nameChars, i);
             PyLib_HandlePythonException(jenv);
-            goto error;
+            Py_DECREF(pyArgs);
+            return NULL;
         }
 
         // pyArg reference stolen here
         PyTuple_SetItem(pyArgs, i, pyArg);
     }
 
-    // Check why: for some reason, we don't need the following code to invoke object methods.
-    /*
-    if (isMethodCall) {
-        PyObject* pyMethod;
+    return pyArgs;
+}
 
-        pyMethod = PyMethod_New(pyCallable, pyObject);
-        if (pyMethod == NULL) {
-            JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "PyLib_CallAndReturnObject: error: callable '%s': no memory\n", nameChars);
-            PyLib_HandlePythonException(jenv);
-            goto error;
-        }
-        Py_DECREF(pyCallable);
-        pyCallable = pyMethod;
+/**
+ * Converts the Java arguments (see PyLib_NewArgsTuple()) and calls the Python callable.
+ * Returns a new reference to the call's result, or NULL, in which case a Java exception has been thrown.
+ */
+PyObject* PyLib_CallCallable(JNIEnv *jenv, PyObject* pyCallable, const char* nameChars, jint argCount, jobjectArray jArgs, jobjectArray jParamClasses, JPy_JType** paramTypes)
+{
+    PyObject* pyArgs;
+    PyObject* pyReturnValue;
+
+    pyArgs = PyLib_NewArgsTuple(jenv, nameChars, argCount, jArgs, jParamClasses, paramTypes);
+    if (pyArgs == NULL) {
+        return NULL;
     }
-    */
 
     pyReturnValue = PyObject_CallObject(pyCallable, argCount > 0 ? pyArgs : NULL);
+    Py_DECREF(pyArgs);
     if (pyReturnValue == NULL) {
-        JPy_DIAG_PRINT(JPy_DIAG_F_ALL, "PyLib_CallAndReturnObject: error: callable '%s': call returned NULL\n", nameChars);
+        JPy_DIAG_PRINT(JPy_DIAG_F_ALL, "PyLib_CallCallable: error: callable '%s': call returned NULL\n", nameChars);
         PyLib_HandlePythonException(jenv);
-        goto error;
-    }
-
-    Py_INCREF(pyReturnValue);
-
-error:
-    if (nameChars != NULL) {
-        (*jenv)->ReleaseStringUTFChars(jenv, jName, nameChars);
+        return NULL;
     }
-    Py_XDECREF(pyCallable);
-    Py_XDECREF(pyArgs);
 
     return pyReturnValue;
 }
@@ -1952,12 +2952,13 @@ char* PyLib_ObjToChars(PyObject* pyObj, PyObject** pyNewRef)
 #define JPY_NO_INFO_MSG JPY_ERR_BASE_MSG ", no information available"
 #define JPY_INFO_ALLOC_FAILED_MSG JPY_ERR_BASE_MSG ", failed to allocate information text"
 
-void PyLib_HandlePythonException(JNIEnv* jenv)
+/**
+ * Formats the Java exception message describing a Python exception, given by its type, value and traceback,
+ * any of which may be NULL. Returns a new string, which must be released by PyMem_Del(), or NULL if no
+ * information is available.
+ */
+char* PyLib_FormatPythonException(PyObject* pyType, PyObject* pyValue, PyObject* pyTraceback)
 {
-    PyObject* pyType = NULL;
-    PyObject* pyValue = NULL;
-    PyObject* pyTraceback = NULL;
-
     PyObject* pyTypeUtf8 = NULL;
     PyObject* pyValueUtf8 = NULL;
     PyObject* pyLinenoUtf8 = NULL;
@@ -1968,44 +2969,34 @@ void PyLib_HandlePythonException(JNIEnv* jenv)
     char* linenoChars = NULL;
     char* filenameChars = NULL;
     char* namespaceChars = NULL;
-
-    jclass jExceptionClass;
-
-    if (PyErr_Occurred() == NULL) {
-        return;
-    }
-
-    PyErr_Fetch(&pyType, &pyValue, &pyTraceback);
-    //printf("M1: pyType=%p, pyValue=%p, pyTraceback=%p\n", pyType, pyValue, pyTraceback);
-    //printf("U1: pyType=%s, pyValue=%s, pyTraceback=%s\n", Py_TYPE(pyType)->tp_name, Py_TYPE(pyValue)->tp_name, pyTraceback != NULL ? Py_TYPE(pyTraceback)->tp_name : "?");
-    PyErr_NormalizeException(&pyType, &pyValue, &pyTraceback);
-    //printf("M2: pyType=%p, pyValue=%p, pyTraceback=%p\n", pyType, pyValue, pyTraceback);
-    //printf("U2: pyType=%s, pyValue=%s, pyTraceback=%s\n", Py_TYPE(pyType)->tp_name, Py_TYPE(pyValue)->tp_name, pyTraceback != NULL ? Py_TYPE(pyTraceback)->tp_name : "?");
+    char* javaMessage = NULL;
 
     typeChars = PyLib_ObjToChars(pyType, &pyTypeUtf8);
     valueChars = PyLib_ObjToChars(pyValue, &pyValueUtf8);
-    if (PyObject_TypeCheck(pyValue, (PyTypeObject*) PyExc_KeyError)) {
-        jExceptionClass = JPy_KeyError_JClass;
-    } else if (PyObject_TypeCheck(pyValue, (PyTypeObject*) PyExc_StopIteration)) {
-        jExceptionClass = JPy_StopIteration_JClass;
-    } else {
-        jExceptionClass = JPy_RuntimeException_JClass;
-    }
 
     if (pyTraceback != NULL) {
+        PyObject* pyLineno = NULL;
         PyObject* pyFrame = NULL;
         PyObject* pyCode = NULL;
-        linenoChars = PyLib_ObjToChars(PyObject_GetAttrString(pyTraceback, "tb_lineno"), &pyLinenoUtf8);
+        PyObject* pyFilename = NULL;
+        PyObject* pyNamespace = NULL;
+        pyLineno = PyObject_GetAttrString(pyTraceback, "tb_lineno");
+        linenoChars = PyLib_ObjToChars(pyLineno, &pyLinenoUtf8);
         pyFrame = PyObject_GetAttrString(pyTraceback, "tb_frame");
         if (pyFrame != NULL) {
             pyCode = PyObject_GetAttrString(pyFrame, "f_code");
             if (pyCode != NULL) {
-                filenameChars = PyLib_ObjToChars(PyObject_GetAttrString(pyCode, "co_filename"), &pyFilenameUtf8);
-                namespaceChars = PyLib_ObjToChars(PyObject_GetAttrString(pyCode, "co_name"), &pyNamespaceUtf8);
+                pyFilename = PyObject_GetAttrString(pyCode, "co_filename");
+                filenameChars = PyLib_ObjToChars(pyFilename, &pyFilenameUtf8);
+                pyNamespace = PyObject_GetAttrString(pyCode, "co_name");
+                namespaceChars = PyLib_ObjToChars(pyNamespace, &pyNamespaceUtf8);
             }
         }
+        Py_XDECREF(pyNamespace);
+        Py_XDECREF(pyFilename);
         Py_XDECREF(pyCode);
         Py_XDECREF(pyFrame);
+        Py_XDECREF(pyLineno);
     }
 
     //printf("U2: typeChars=%s, valueChars=%s, linenoChars=%s, filenameChars=%s, namespaceChars=%s\n",
@@ -2013,7 +3004,6 @@ void PyLib_HandlePythonException(JNIEnv* jenv)
 
     if (typeChars != NULL || valueChars != NULL
         || linenoChars != NULL || filenameChars != NULL || namespaceChars != NULL) {
-        char* javaMessage;
         javaMessage = PyMem_New(char,
                                 (typeChars != NULL ? strlen(typeChars) : JPY_NOT_AVAILABLE_MSG_LEN)
                                + (valueChars != NULL ? strlen(valueChars) : JPY_NOT_AVAILABLE_MSG_LEN)
@@ -2033,24 +3023,93 @@ void PyLib_HandlePythonException(JNIEnv* jenv)
                     linenoChars != NULL ? linenoChars : JPY_NOT_AVAILABLE_MSG,
                     namespaceChars != NULL ? namespaceChars : JPY_NOT_AVAILABLE_MSG,
                     filenameChars != NULL ? filenameChars : JPY_NOT_AVAILABLE_MSG);
-            (*jenv)->ThrowNew(jenv, jExceptionClass, javaMessage);
-            PyMem_Del(javaMessage);
-        } else {
-            (*jenv)->ThrowNew(jenv, jExceptionClass, JPY_INFO_ALLOC_FAILED_MSG);
         }
-    } else {
-        (*jenv)->ThrowNew(jenv, jExceptionClass, JPY_NO_INFO_MSG);
     }
 
-    Py_XDECREF(pyType);
-    Py_XDECREF(pyValue);
-    Py_XDECREF(pyTraceback);
     Py_XDECREF(pyTypeUtf8);
     Py_XDECREF(pyValueUtf8);
     Py_XDECREF(pyLinenoUtf8);
     Py_XDECREF(pyFilenameUtf8);
     Py_XDECREF(pyNamespaceUtf8);
 
+    return javaMessage;
+}
+
+void PyLib_ThrowFormattedPythonException(JNIEnv* jenv, jclass jExceptionClass, PyObject* pyType, PyObject* pyValue, PyObject* pyTraceback)
+{
+    char* javaMessage;
+
+    javaMessage = PyLib_FormatPythonException(pyType, pyValue, pyTraceback);
+    if (javaMessage != NULL) {
+        (*jenv)->ThrowNew(jenv, jExceptionClass, javaMessage);
+        PyMem_Del(javaMessage);
+    } else {
+        (*jenv)->ThrowNew(jenv, jExceptionClass, JPY_NO_INFO_MSG);
+    }
+}
+
+/**
+ * Translates the current Python error into a Java exception, which is thrown.
+ *
+ * The thrown org.jpy.PyException (or its subclass org.jpy.KeyError or org.jpy.StopIteration) takes over the
+ * references to the Python exception and its traceback, and formats its message only on demand.
+ */
+void PyLib_HandlePythonException(JNIEnv* jenv)
+{
+    PyObject* pyType = NULL;
+    PyObject* pyValue = NULL;
+    PyObject* pyTraceback = NULL;
+
+    jclass jExceptionClass;
+    jmethodID jExceptionInitMID;
+    jthrowable jException;
+
+    if (PyErr_Occurred() == NULL) {
+        return;
+    }
+
+    PyErr_Fetch(&pyType, &pyValue, &pyTraceback);
+    //printf("M1: pyType=%p, pyValue=%p, pyTraceback=%p\n", pyType, pyValue, pyTraceback);
+    //printf("U1: pyType=%s, pyValue=%s, pyTraceback=%s\n", Py_TYPE(pyType)->tp_name, Py_TYPE(pyValue)->tp_name, pyTraceback != NULL ? Py_TYPE(pyTraceback)->tp_name : "?");
+    PyErr_NormalizeException(&pyType, &pyValue, &pyTraceback);
+    //printf("M2: pyType=%p, pyValue=%p, pyTraceback=%p\n", pyType, pyValue, pyTraceback);
+    //printf("U2: pyType=%s, pyValue=%s, pyTraceback=%s\n", Py_TYPE(pyType)->tp_name, Py_TYPE(pyValue)->tp_name, pyTraceback != NULL ? Py_TYPE(pyTraceback)->tp_name : "?");
+
+    if (PyObject_TypeCheck(pyValue, (PyTypeObject*) PyExc_KeyError)) {
+        jExceptionClass = JPy_KeyError_JClass;
+        jExceptionInitMID = JPy_KeyError_Init_MID;
+    } else if (PyObject_TypeCheck(pyValue, (PyTypeObject*) PyExc_StopIteration)) {
+        jExceptionClass = JPy_StopIteration_JClass;
+        jExceptionInitMID = JPy_StopIteration_Init_MID;
+    } else {
+        jExceptionClass = JPy_PyException_JClass;
+        jExceptionInitMID = JPy_PyException_Init_MID;
+    }
+
+    if (pyValue == NULL || jExceptionClass == NULL || jExceptionInitMID == NULL) {
+        // org.jpy.PyException is not available, so translate eagerly
+        PyLib_ThrowFormattedPythonException(jenv, jExceptionClass != NULL ? jExceptionClass : JPy_RuntimeException_JClass,
+                                            pyType, pyValue, pyTraceback);
+        Py_XDECREF(pyType);
+        Py_XDECREF(pyValue);
+        Py_XDECREF(pyTraceback);
+        PyErr_Clear();
+        return;
+    }
+
+    jException = (*jenv)->NewObject(jenv, jExceptionClass, jExceptionInitMID, (jlong) pyValue, (jlong) pyTraceback);
+    if (jException != NULL) {
+        (*jenv)->Throw(jenv, jException);
+        (*jenv)->DeleteLocalRef(jenv, jException);
+    } else {
+        // The exception's constructor failed, e.g. due to an OutOfMemoryError. It may have taken over the references
+        // already, so they are not released here (they cannot be released by Java either while we hold the GIL).
+        (*jenv)->ExceptionClear(jenv);
+        PyLib_ThrowFormattedPythonException(jenv, JPy_RuntimeException_JClass, pyType, pyValue, pyTraceback);
+    }
+
+    Py_XDECREF(pyType);
+
     PyErr_Clear();
 }
 
@@ -2088,6 +3147,23 @@ void PyLib_ThrowRTE(JNIEnv* jenv, const char *message) {
     (*jenv)->ThrowNew(jenv, JPy_RuntimeException_JClass, message);
 }
 
+/**
+ * Throw an IndexOutOfBoundsException.
+ * @param jenv the jni environment
+ * @param index the illegal index
+ */
+void PyLib_ThrowIOOBE(JNIEnv* jenv, jint index) {
+    jclass jExceptionClass;
+    char message[64];
+
+    jExceptionClass = (*jenv)->FindClass(jenv, "java/lang/IndexOutOfBoundsException");
+    if (jExceptionClass != NULL) {
+        sprintf(message, "index out of range: %d", index);
+        (*jenv)->ThrowNew(jenv, jExceptionClass, message);
+        (*jenv)->DeleteLocalRef(jenv, jExceptionClass);
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////
 // Redirect stdout
 
@@ -47,6 +47,70 @@ JNIEXPORT jstring JNICALL Java_org_jpy_PyLib_getPythonVersion
 JNIEXPORT void JNICALL Java_org_jpy_PyLib_stopPython0
   (JNIEnv *, jclass);
 
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    hasGil
+ * Signature: ()Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_jpy_PyLib_hasGil
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    setGilWatchdogEnabled
+ * Signature: (Z)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_jpy_PyLib_setGilWatchdogEnabled
+  (JNIEnv *, jclass, jboolean);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    getGilWatchdogState
+ * Signature: ()[J
+ */
+JNIEXPORT jlongArray JNICALL Java_org_jpy_PyLib_getGilWatchdogState
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    releaseGilWatchdogThreads
+ * Signature: ([J)V
+ */
+JNIEXPORT void JNICALL Java_org_jpy_PyLib_releaseGilWatchdogThreads
+  (JNIEnv *, jclass, jlongArray);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    dumpPythonStacks
+ * Signature: ()Ljava/lang/String;
+ */
+JNIEXPORT jstring JNICALL Java_org_jpy_PyLib_dumpPythonStacks
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    acquireGil0
+ * Signature: ()J
+ */
+JNIEXPORT jlong JNICALL Java_org_jpy_PyLib_acquireGil0
+  (JNIEnv *, jclass);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    releaseGil0
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_org_jpy_PyLib_releaseGil0
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    completeFuture
+ * Signature: (JLjava/lang/Object;Ljava/lang/Throwable;)V
+ */
+JNIEXPORT void JNICALL Java_org_jpy_PyLib_completeFuture
+  (JNIEnv *, jclass, jlong, jobject, jthrowable);
+
 /*
  * Class:     org_jpy_PyLib
  * Method:    execScript
@@ -71,6 +135,22 @@ JNIEXPORT jlong JNICALL Java_org_jpy_PyLib_executeCode
 JNIEXPORT jlong JNICALL Java_org_jpy_PyLib_executeScript
   (JNIEnv *, jclass, jstring, jint, jobject, jobject);
 
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    compileCode
+ * Signature: (Ljava/lang/String;I)J
+ */
+JNIEXPORT jlong JNICALL Java_org_jpy_PyLib_compileCode
+  (JNIEnv *, jclass, jstring, jint);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    executeCompiledCode
+ * Signature: (JLjava/lang/Object;Ljava/lang/Object;)J
+ */
+JNIEXPORT jlong JNICALL Java_org_jpy_PyLib_executeCompiledCode
+  (JNIEnv *, jclass, jlong, jobject, jobject);
+
 /*
  * Class:     org_jpy_PyLib
  * Method:    getMainGlobals
@@ -103,6 +183,22 @@ JNIEXPORT void JNICALL Java_org_jpy_PyLib_incRef
 JNIEXPORT void JNICALL Java_org_jpy_PyLib_decRef
   (JNIEnv *, jclass, jlong);
 
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    decRefs
+ * Signature: ([JI)V
+ */
+JNIEXPORT void JNICALL Java_org_jpy_PyLib_decRefs
+  (JNIEnv *, jclass, jlongArray, jint);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    formatException
+ * Signature: (JJ)Ljava/lang/String;
+ */
+JNIEXPORT jstring JNICALL Java_org_jpy_PyLib_formatException
+  (JNIEnv *, jclass, jlong, jlong);
+
 /*
  * Class:     org_jpy_PyLib
  * Method:    getIntValue
@@ -327,6 +423,110 @@ JNIEXPORT jlong JNICALL Java_org_jpy_PyLib_callAndReturnObject
 JNIEXPORT jobject JNICALL Java_org_jpy_PyLib_callAndReturnValue
   (JNIEnv *, jclass, jlong, jboolean, jstring, jint, jobjectArray, jobjectArray, jclass);
 
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    resolveParamTypes
+ * Signature: ([Ljava/lang/Class;)J
+ */
+JNIEXPORT jlong JNICALL Java_org_jpy_PyLib_resolveParamTypes
+  (JNIEnv *, jclass, jobjectArray);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    releaseParamTypes
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_org_jpy_PyLib_releaseParamTypes
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    callObject
+ * Signature: (JI[Ljava/lang/Object;J)J
+ */
+JNIEXPORT jlong JNICALL Java_org_jpy_PyLib_callObject
+  (JNIEnv *, jclass, jlong, jint, jobjectArray, jlong);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    callObjectAndReturnValue
+ * Signature: (JI[Ljava/lang/Object;JLjava/lang/Class;)Ljava/lang/Object;
+ */
+JNIEXPORT jobject JNICALL Java_org_jpy_PyLib_callObjectAndReturnValue
+  (JNIEnv *, jclass, jlong, jint, jobjectArray, jlong, jclass);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    callDouble
+ * Signature: (JIIJJJJ)D
+ */
+JNIEXPORT jdouble JNICALL Java_org_jpy_PyLib_callDouble
+  (JNIEnv *, jclass, jlong, jint, jint, jlong, jlong, jlong, jlong);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    callLong
+ * Signature: (JIIJJJJ)J
+ */
+JNIEXPORT jlong JNICALL Java_org_jpy_PyLib_callLong
+  (JNIEnv *, jclass, jlong, jint, jint, jlong, jlong, jlong, jlong);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    getLength
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_org_jpy_PyLib_getLength
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    listGetItem
+ * Signature: (JI)J
+ */
+JNIEXPORT jlong JNICALL Java_org_jpy_PyLib_listGetItem
+  (JNIEnv *, jclass, jlong, jint);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    listGetItems
+ * Signature: (JII)[J
+ */
+JNIEXPORT jlongArray JNICALL Java_org_jpy_PyLib_listGetItems
+  (JNIEnv *, jclass, jlong, jint, jint);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    dictGetItem
+ * Signature: (JLjava/lang/Object;)J
+ */
+JNIEXPORT jlong JNICALL Java_org_jpy_PyLib_dictGetItem
+  (JNIEnv *, jclass, jlong, jobject);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    dictContainsKey
+ * Signature: (JLjava/lang/Object;)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_jpy_PyLib_dictContainsKey
+  (JNIEnv *, jclass, jlong, jobject);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    dictNext
+ * Signature: (JJ[J)J
+ */
+JNIEXPORT jlong JNICALL Java_org_jpy_PyLib_dictNext
+  (JNIEnv *, jclass, jlong, jlong, jlongArray);
+
+/*
+ * Class:     org_jpy_PyLib
+ * Method:    dictGetItems
+ * Signature: (J)[J
+ */
+JNIEXPORT jlongArray JNICALL Java_org_jpy_PyLib_dictGetItems
+  (JNIEnv *, jclass, jlong);
+
 #ifdef __cplusplus
 }
 #endif
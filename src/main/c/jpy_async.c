@@ -0,0 +1,315 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "jpy_module.h"
+#include "jpy_diag.h"
+#include "jpy_jtype.h"
+#include "jpy_jobj.h"
+#include "jpy_conv.h"
+#include "jpy_async.h"
+
+
+JPy_THREAD_LOCAL int JPy_NoGilDepth = 0;
+
+/**
+ * Implements the jpy.call_nogil(callable, *args, **kwargs) function.
+ */
+PyObject* JPy_call_nogil(PyObject* self, PyObject* args, PyObject* kwds)
+{
+    PyObject* callable;
+    PyObject* callArgs;
+    PyObject* result;
+
+    if (PyTuple_Size(args) < 1) {
+        PyErr_SetString(PyExc_TypeError, "call_nogil() missing required argument 'callable'");
+        return NULL;
+    }
+
+    callable = PyTuple_GetItem(args, 0);
+    callArgs = PyTuple_GetSlice(args, 1, PyTuple_Size(args));
+    if (callArgs == NULL) {
+        return NULL;
+    }
+
+    JPy_NoGilDepth++;
+    result = PyObject_Call(callable, callArgs, kwds);
+    JPy_NoGilDepth--;
+
+    Py_DECREF(callArgs);
+    return result;
+}
+
+/**
+ * Runs jpy.call_nogil(callable, *args, **kwargs) in the default executor of the current asyncio event loop.
+ * Returns a new reference to the resulting asyncio future.
+ */
+static PyObject* JAsync_RunInExecutor(PyObject* loop, PyObject* args, PyObject* kwds)
+{
+    PyObject* functools;
+    PyObject* callNoGil;
+    PyObject* partialArgs;
+    PyObject* partial;
+    PyObject* future;
+    Py_ssize_t i, argCount;
+
+    callNoGil = PyObject_GetAttrString(JPy_Module, "call_nogil");
+    if (callNoGil == NULL) {
+        return NULL;
+    }
+
+    argCount = PyTuple_Size(args);
+    partialArgs = PyTuple_New(argCount + 1);
+    if (partialArgs == NULL) {
+        Py_DECREF(callNoGil);
+        return NULL;
+    }
+    PyTuple_SET_ITEM(partialArgs, 0, callNoGil);
+    for (i = 0; i < argCount; i++) {
+        PyObject* arg = PyTuple_GET_ITEM(args, i);
+        Py_INCREF(arg);
+        PyTuple_SET_ITEM(partialArgs, i + 1, arg);
+    }
+
+    // run_in_executor() doesn't pass keyword arguments, so bind all arguments with functools.partial()
+    partial = NULL;
+    functools = PyImport_ImportModule("functools");
+    if (functools != NULL) {
+        PyObject* partialType = PyObject_GetAttrString(functools, "partial");
+        if (partialType != NULL) {
+            partial = PyObject_Call(partialType, partialArgs, kwds);
+            Py_DECREF(partialType);
+        }
+        Py_DECREF(functools);
+    }
+    Py_DECREF(partialArgs);
+    if (partial == NULL) {
+        return NULL;
+    }
+
+    future = PyObject_CallMethod(loop, "run_in_executor", "OO", Py_None, partial);
+    Py_DECREF(partial);
+    return future;
+}
+
+/**
+ * Returns a new reference to the current asyncio event loop.
+ */
+static PyObject* JAsync_GetEventLoop(void)
+{
+    PyObject* asyncio;
+    PyObject* loop;
+
+    asyncio = PyImport_ImportModule("asyncio");
+    if (asyncio == NULL) {
+        return NULL;
+    }
+#if PY_VERSION_HEX >= 0x03070000
+    // Raises a RuntimeError unless called from a coroutine or a callback of a running loop
+    loop = PyObject_CallMethod(asyncio, "get_running_loop", NULL);
+#else
+    // Within a coroutine, this is the running loop
+    loop = PyObject_CallMethod(asyncio, "get_event_loop", NULL);
+#endif
+    Py_DECREF(asyncio);
+    return loop;
+}
+
+/**
+ * Implements the jpy.call_async(callable, *args, **kwargs) function.
+ */
+PyObject* JPy_call_async(PyObject* self, PyObject* args, PyObject* kwds)
+{
+    PyObject* loop;
+    PyObject* future;
+
+    if (PyTuple_Size(args) < 1) {
+        PyErr_SetString(PyExc_TypeError, "call_async() missing required argument 'callable'");
+        return NULL;
+    }
+
+    loop = JAsync_GetEventLoop();
+    if (loop == NULL) {
+        return NULL;
+    }
+
+    future = JAsync_RunInExecutor(loop, args, kwds);
+    Py_DECREF(loop);
+    return future;
+}
+
+int JAsync_IsAwaitableType(JNIEnv* jenv, JPy_JType* type)
+{
+    if (jenv == NULL || type->classRef == NULL || type->isPrimitive) {
+        return 0;
+    }
+    return (JPy_CompletionStage_JClass != NULL && (*jenv)->IsAssignableFrom(jenv, type->classRef, JPy_CompletionStage_JClass))
+           || (JPy_Future_JClass != NULL && (*jenv)->IsAssignableFrom(jenv, type->classRef, JPy_Future_JClass));
+}
+
+/**
+ * The callback scheduled in the event loop by JAsync_CompleteFuture(): _set_future(future, is_error, value).
+ */
+static PyObject* JAsync_SetFuture(PyObject* self, PyObject* args)
+{
+    PyObject* future;
+    PyObject* value;
+    PyObject* cancelled;
+    int isError;
+    int isCancelled;
+
+    if (!PyArg_ParseTuple(args, "OiO:_set_future", &future, &isError, &value)) {
+        return NULL;
+    }
+
+    // The awaiting task may have been cancelled meanwhile
+    cancelled = PyObject_CallMethod(future, "cancelled", NULL);
+    if (cancelled == NULL) {
+        return NULL;
+    }
+    isCancelled = PyObject_IsTrue(cancelled);
+    Py_DECREF(cancelled);
+    if (isCancelled) {
+        return Py_BuildValue("");
+    }
+
+    return PyObject_CallMethod(future, isError ? "set_exception" : "set_result", "O", value);
+}
+
+static PyMethodDef JAsync_SetFuture_Def = {"_set_future", JAsync_SetFuture, METH_VARARGS, NULL};
+
+void JAsync_CompleteFuture(JNIEnv* jenv, PyObject* pyFutureRef, jobject jValue, jthrowable jError)
+{
+    PyObject* loop;
+    PyObject* future;
+    PyObject* pyValue;
+    PyObject* setFuture;
+    PyObject* result;
+    int isError;
+
+    loop = PyTuple_GetItem(pyFutureRef, 0);
+    future = PyTuple_GetItem(pyFutureRef, 1);
+
+    if (jError != NULL) {
+        // Raise the jpy.JException and take it back, this attaches the Java exception to it
+        JException_Raise(jenv, jError);
+        pyValue = NULL;
+    } else if (jValue == NULL) {
+        pyValue = Py_BuildValue("");
+    } else {
+        pyValue = JPy_FromJObject(jenv, jValue);
+    }
+
+    isError = pyValue == NULL;
+    if (isError) {
+        PyObject* pyType;
+        PyObject* pyTraceback;
+        PyErr_Fetch(&pyType, &pyValue, &pyTraceback);
+        PyErr_NormalizeException(&pyType, &pyValue, &pyTraceback);
+        Py_XDECREF(pyType);
+        Py_XDECREF(pyTraceback);
+        if (pyValue == NULL) {
+            pyValue = PyObject_CallFunction(PyExc_RuntimeError, "s", "jpy: failed to complete future");
+        }
+    }
+
+    // The future must only be completed from within its event loop, which wakes up through its self-pipe
+    result = NULL;
+    setFuture = PyCFunction_New(&JAsync_SetFuture_Def, NULL);
+    if (setFuture != NULL && pyValue != NULL) {
+        result = PyObject_CallMethod(loop, "call_soon_threadsafe", "OOiO", setFuture, future, isError, pyValue);
+    }
+    if (result == NULL) {
+        // E.g. the event loop has been closed meanwhile
+        JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "JAsync_CompleteFuture: error: failed to schedule the completion of a future\n");
+        PyErr_Clear();
+    }
+
+    Py_XDECREF(result);
+    Py_XDECREF(setFuture);
+    Py_XDECREF(pyValue);
+    Py_DECREF(pyFutureRef);
+}
+
+#if defined(JPY_COMPAT_35P)
+
+/**
+ * The am_await slot of Java types implementing java.util.concurrent.CompletionStage or java.util.concurrent.Future.
+ */
+static PyObject* JObj_await(JPy_JObj* self)
+{
+    JNIEnv* jenv;
+    PyObject* loop;
+    PyObject* future;
+    PyObject* iterator;
+
+    JPy_GET_JNI_ENV_OR_RETURN(jenv, NULL)
+
+    loop = JAsync_GetEventLoop();
+    if (loop == NULL) {
+        return NULL;
+    }
+
+    if (JPy_PyFutures_JClass != NULL && (*jenv)->IsInstanceOf(jenv, self->objectRef, JPy_CompletionStage_JClass)) {
+        // Completed from the Java thread completing the stage, see Java_org_jpy_PyLib_completeFuture()
+        PyObject* pyFutureRef;
+        future = PyObject_CallMethod(loop, "create_future", NULL);
+        if (future == NULL) {
+            Py_DECREF(loop);
+            return NULL;
+        }
+        pyFutureRef = PyTuple_Pack(2, loop, future);
+        if (pyFutureRef == NULL) {
+            Py_DECREF(future);
+            Py_DECREF(loop);
+            return NULL;
+        }
+        // PyFutures.whenComplete() always completes the future, and so releases pyFutureRef
+        (*jenv)->CallStaticVoidMethod(jenv, JPy_PyFutures_JClass, JPy_PyFutures_WhenComplete_SMID, self->objectRef, (jlong) pyFutureRef);
+        if ((*jenv)->ExceptionCheck(jenv)) {
+            JPy_HandleJavaException(jenv);
+            Py_DECREF(future);
+            Py_DECREF(loop);
+            return NULL;
+        }
+    } else {
+        // A plain Future can only be waited for by blocking, so do this in the loop's executor without the GIL
+        PyObject* args = Py_BuildValue("(N)", PyObject_GetAttrString((PyObject*) self, "get"));
+        if (args == NULL) {
+            Py_DECREF(loop);
+            return NULL;
+        }
+        future = JAsync_RunInExecutor(loop, args, NULL);
+        Py_DECREF(args);
+        if (future == NULL) {
+            Py_DECREF(loop);
+            return NULL;
+        }
+    }
+
+    iterator = PyObject_CallMethod(future, "__await__", NULL);
+    Py_DECREF(future);
+    Py_DECREF(loop);
+    return iterator;
+}
+
+PyAsyncMethods JObj_as_async = {
+    (unaryfunc) JObj_await,  /* am_await */
+    NULL,                    /* am_aiter */
+    NULL,                    /* am_anext */
+};
+
+#endif
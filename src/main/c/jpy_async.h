@@ -0,0 +1,86 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef JPY_ASYNC_H
+#define JPY_ASYNC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "jpy_compat.h"
+#include "jpy_watchdog.h"
+
+/**
+ * Greater than zero while the current thread runs a callable passed to jpy.call_nogil(),
+ * in which case Java methods are invoked with the GIL released.
+ */
+extern JPy_THREAD_LOCAL int JPy_NoGilDepth;
+
+/**
+ * Called before the GIL is released for a Java call. The org.jpy.GilScope instances open in the current thread
+ * no longer hold the GIL until JPy_ResumeGilScopes() is called, so that PyLib calls made by the Java method
+ * acquire the GIL again. Defined in org_jpy_PyLib.c.
+ */
+int JPy_SuspendGilScopes(int* previousHolder);
+void JPy_ResumeGilScopes(JNIEnv* jenv, int depth, int previousHolder);
+
+/**
+ * Performs the given JNI call of a Java method, releasing the GIL if requested by jpy.call_nogil().
+ * Otherwise the current thread is tracked as the GIL holder if the GIL watchdog runs. Requires jenv in scope.
+ */
+#define JPy_CALL_JAVA(CALL) \
+    do { \
+        if (JPy_NoGilDepth > 0) { \
+            int gilScopeHolder; \
+            int gilScopeDepth = JPy_SuspendGilScopes(&gilScopeHolder); \
+            Py_BEGIN_ALLOW_THREADS \
+            CALL; \
+            Py_END_ALLOW_THREADS \
+            JPy_ResumeGilScopes(jenv, gilScopeDepth, gilScopeHolder); \
+        } else if (JPy_WatchdogEnabled) { \
+            int previousHolder = JWatchdog_EnterJava(jenv); \
+            CALL; \
+            JWatchdog_ExitJava(previousHolder); \
+        } else { \
+            CALL; \
+        } \
+    } while (0)
+
+PyObject* JPy_call_nogil(PyObject* self, PyObject* args, PyObject* kwds);
+PyObject* JPy_call_async(PyObject* self, PyObject* args, PyObject* kwds);
+
+/**
+ * Returns non-zero if Java objects of the given type can be awaited in Python coroutines,
+ * i.e. if the type implements java.util.concurrent.CompletionStage or java.util.concurrent.Future.
+ */
+int JAsync_IsAwaitableType(JNIEnv* jenv, JPy_JType* type);
+
+#if defined(JPY_COMPAT_35P)
+extern PyAsyncMethods JObj_as_async;
+#endif
+
+/**
+ * Completes the asyncio future referred to by pyFutureRef, a (loop, future) tuple, with the given value or error.
+ * Steals the reference to pyFutureRef. Must be called with the GIL held.
+ */
+void JAsync_CompleteFuture(JNIEnv* jenv, PyObject* pyFutureRef, jobject jValue, jthrowable jError);
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+#endif /* !JPY_ASYNC_H */
@@ -22,6 +22,26 @@ extern "C" {
 #endif
 
 #include <Python.h>
+#include <pythread.h>
+
+#if defined(_MSC_VER)
+    #define JPy_THREAD_LOCAL __declspec(thread)
+#else
+    #define JPy_THREAD_LOCAL __thread
+#endif
+
+// Free-threaded CPython builds (3.13t+), in which Python threads run in parallel without a GIL
+#if defined(Py_GIL_DISABLED)
+#define JPY_FREE_THREADED 1
+#endif
+
+// Object header setters, which must be used since Python 3.10 and the only way to set the
+// reference count of free-threaded builds
+#if PY_VERSION_HEX < 0x030900A4
+#define Py_SET_REFCNT(ob, refcnt) (((PyObject*) (ob))->ob_refcnt = (refcnt))
+#define Py_SET_TYPE(ob, type)     (((PyObject*) (ob))->ob_type = (type))
+#define Py_SET_SIZE(ob, size)     (((PyVarObject*) (ob))->ob_size = (size))
+#endif
 
 #define JPY_VERSION_ERROR "jpy requires either Python 2.7 or Python 3.3+"
 
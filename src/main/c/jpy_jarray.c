@@ -17,6 +17,8 @@
 #include "jpy_module.h"
 #include "jpy_diag.h"
 #include "jpy_jarray.h"
+#include "jpy_jtype.h"
+#include "jpy_jobj.h"
 
 
 #define PRINT_FLAG(F) printf("JArray_GetBufferProc: %s = %d\n", #F, (flags & F) != 0);
@@ -62,53 +64,59 @@ int JArray_GetBufferProc(JPy_JArray* self, Py_buffer* view, int flags, char java
     PRINT_FLAG(PyBUF_WRITEABLE);
     */
 
-    itemCount = (*jenv)->GetArrayLength(jenv, self->objectRef);
+    // All exports share the same array elements and buffer metadata. Only the first export
+    // acquires the elements, subsequent ones just increment the export count (step 3/5).
+    if (self->bufferExportCount == 0) {
+        itemCount = (*jenv)->GetArrayLength(jenv, self->objectRef);
 
-    // According to Python documentation,
-    // buffer allocation shall be done in the 5 following steps;
+        // According to Python documentation,
+        // buffer allocation shall be done in the 5 following steps;
 
-    // Step 1/5
+        // Step 1/5
 #ifdef JPy_USE_GET_PRIMITIVE_ARRAY_CRITICAL
-    buf = (*jenv)->GetPrimitiveArrayCritical(jenv, self->objectRef, &isCopy);
+        buf = (*jenv)->GetPrimitiveArrayCritical(jenv, self->objectRef, &isCopy);
 #else
-    if (javaType == 'Z') {
-        buf = (*jenv)->GetBooleanArrayElements(jenv, self->objectRef, &isCopy);
-    } else if (javaType == 'C') {
-        buf = (*jenv)->GetCharArrayElements(jenv, self->objectRef, &isCopy);
-    } else if (javaType == 'B') {
-        buf = (*jenv)->GetByteArrayElements(jenv, self->objectRef, &isCopy);
-    } else if (javaType == 'S') {
-        buf = (*jenv)->GetShortArrayElements(jenv, self->objectRef, &isCopy);
-    } else if (javaType == 'I') {
-        buf = (*jenv)->GetIntArrayElements(jenv, self->objectRef, &isCopy);
-    } else if (javaType == 'J') {
-        buf = (*jenv)->GetLongArrayElements(jenv, self->objectRef, &isCopy);
-    } else if (javaType == 'F') {
-        buf = (*jenv)->GetFloatArrayElements(jenv, self->objectRef, &isCopy);
-    } else if (javaType == 'D') {
-        buf = (*jenv)->GetDoubleArrayElements(jenv, self->objectRef, &isCopy);
-    } else {
-        PyErr_Format(PyExc_RuntimeError, "internal error: illegal Java array type '%c'", javaType);
-        return -1;
-    }
+        if (javaType == 'Z') {
+            buf = (*jenv)->GetBooleanArrayElements(jenv, self->objectRef, &isCopy);
+        } else if (javaType == 'C') {
+            buf = (*jenv)->GetCharArrayElements(jenv, self->objectRef, &isCopy);
+        } else if (javaType == 'B') {
+            buf = (*jenv)->GetByteArrayElements(jenv, self->objectRef, &isCopy);
+        } else if (javaType == 'S') {
+            buf = (*jenv)->GetShortArrayElements(jenv, self->objectRef, &isCopy);
+        } else if (javaType == 'I') {
+            buf = (*jenv)->GetIntArrayElements(jenv, self->objectRef, &isCopy);
+        } else if (javaType == 'J') {
+            buf = (*jenv)->GetLongArrayElements(jenv, self->objectRef, &isCopy);
+        } else if (javaType == 'F') {
+            buf = (*jenv)->GetFloatArrayElements(jenv, self->objectRef, &isCopy);
+        } else if (javaType == 'D') {
+            buf = (*jenv)->GetDoubleArrayElements(jenv, self->objectRef, &isCopy);
+        } else {
+            PyErr_Format(PyExc_RuntimeError, "internal error: illegal Java array type '%c'", javaType);
+            return -1;
+        }
 #endif
-    if (buf == NULL) {
-        PyErr_NoMemory();
-        return -1;
-    }
+        if (buf == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
 
-    JPy_DIAG_PRINT(JPy_DIAG_F_MEM, "JArray_GetBufferProc: buf=%p, type='%s', format='%s', itemSize=%d, itemCount=%d, isCopy=%d\n", buf, Py_TYPE(self)->tp_name, format, itemSize, itemCount, isCopy);
+        JPy_DIAG_PRINT(JPy_DIAG_F_MEM, "JArray_GetBufferProc: buf=%p, type='%s', format='%s', itemSize=%d, itemCount=%d, isCopy=%d\n", buf, Py_TYPE(self)->tp_name, format, itemSize, itemCount, isCopy);
+
+        self->bufferElements = buf;
+        self->bufferShape[0] = itemCount;
+        self->bufferStrides[0] = itemSize;
+    }
 
     // Step 2/5
-    view->buf = buf;
-    view->len = itemCount * itemSize;
+    view->buf = self->bufferElements;
+    view->len = self->bufferShape[0] * itemSize;
     view->itemsize = itemSize;
     view->readonly = (flags & (PyBUF_WRITE | PyBUF_WRITEABLE)) == 0;
     view->ndim = 1;
-    view->shape = PyMem_New(Py_ssize_t, 1);
-    *view->shape = itemCount;
-    view->strides = PyMem_New(Py_ssize_t, 1);
-    *view->strides = itemSize;
+    view->shape = self->bufferShape;
+    view->strides = self->bufferStrides;
     view->suboffsets = NULL;
     if ((flags & PyBUF_FORMAT) != 0) {
         view->format = (char*) format;
@@ -183,42 +191,45 @@ int JArray_getbufferproc_double(JPy_JArray* self, Py_buffer* view, int flags)
  */
 void JArray_ReleaseBufferProc(JPy_JArray* self, Py_buffer* view, char javaType)
 {
+    void* buf;
+
     // Step 1
     self->bufferExportCount--;
 
     JPy_DIAG_PRINT(JPy_DIAG_F_MEM, "JArray_ReleaseBufferProc: buf=%p, bufferExportCount=%d\n", view->buf, self->bufferExportCount);
 
-    // Step 2
-    if (self->bufferExportCount == 0 && view->buf != NULL) {
+    // Step 2: the last export releases the shared array elements, copying back any changes
+    buf = self->bufferElements;
+    if (self->bufferExportCount == 0 && buf != NULL) {
         JNIEnv* jenv = JPy_GetJNIEnv();
+        self->bufferElements = NULL;
         if (jenv != NULL) {
 #ifdef JPy_USE_GET_PRIMITIVE_ARRAY_CRITICAL
-           (*jenv)->ReleasePrimitiveArrayCritical(jenv, self->objectRef, view->buf, 0);
+           (*jenv)->ReleasePrimitiveArrayCritical(jenv, self->objectRef, buf, 0);
 #else
             if (javaType == 'Z') {
-                (*jenv)->ReleaseBooleanArrayElements(jenv, self->objectRef, (jboolean*) view->buf, 0);
+                (*jenv)->ReleaseBooleanArrayElements(jenv, self->objectRef, (jboolean*) buf, 0);
             } else if (javaType == 'C') {
-                (*jenv)->ReleaseCharArrayElements(jenv, self->objectRef, (jchar*) view->buf, 0);
+                (*jenv)->ReleaseCharArrayElements(jenv, self->objectRef, (jchar*) buf, 0);
             } else if (javaType == 'B') {
-                (*jenv)->ReleaseByteArrayElements(jenv, self->objectRef, (jbyte*) view->buf, 0);
+                (*jenv)->ReleaseByteArrayElements(jenv, self->objectRef, (jbyte*) buf, 0);
             } else if (javaType == 'S') {
-                (*jenv)->ReleaseShortArrayElements(jenv, self->objectRef, (jshort*) view->buf, 0);
+                (*jenv)->ReleaseShortArrayElements(jenv, self->objectRef, (jshort*) buf, 0);
             } else if (javaType == 'I') {
-                (*jenv)->ReleaseIntArrayElements(jenv, self->objectRef, (jint*) view->buf, 0);
+                (*jenv)->ReleaseIntArrayElements(jenv, self->objectRef, (jint*) buf, 0);
             } else if (javaType == 'J') {
-                (*jenv)->ReleaseLongArrayElements(jenv, self->objectRef, (jlong*) view->buf, 0);
+                (*jenv)->ReleaseLongArrayElements(jenv, self->objectRef, (jlong*) buf, 0);
             } else if (javaType == 'F') {
-                (*jenv)->ReleaseFloatArrayElements(jenv, self->objectRef, (jfloat*) view->buf, 0);
+                (*jenv)->ReleaseFloatArrayElements(jenv, self->objectRef, (jfloat*) buf, 0);
             } else if (javaType == 'D') {
-                (*jenv)->ReleaseDoubleArrayElements(jenv, self->objectRef, (jdouble*) view->buf, 0);
+                (*jenv)->ReleaseDoubleArrayElements(jenv, self->objectRef, (jdouble*) buf, 0);
             }
 #endif
         }
-        view->buf = NULL;
     }
 
-    // todo - check if we must Py_DECREF here
-    //Py_DECREF(view->obj);
+    // Note: view->shape and view->strides point into self, and view->obj is released by
+    // PyBuffer_Release(), so there is nothing else to free here.
 }
 
 // todo: py27: fix all releasebufferproc() functions which have different parameter types in 2.7
@@ -356,3 +367,41 @@ PyBufferProcs JArray_as_buffer_double = {
     (getbufferproc) JArray_getbufferproc_double,
     (releasebufferproc) JArray_releasebufferproc_double
 };
+
+
+/*
+ * Implements the getbuffer() method of the buffer protocol for direct java.nio.ByteBuffer objects,
+ * e.g. a java.nio.MappedByteBuffer. The Python buffer refers to the very same memory as the Java buffer,
+ * so nothing is pinned or copied. The memory stays valid as long as the buffer object is referenced,
+ * which is ensured by view->obj.
+ */
+int JByteBuffer_getbufferproc(JPy_JObj* self, Py_buffer* view, int flags)
+{
+    JNIEnv* jenv;
+    void* buf;
+    jlong capacity;
+    jboolean readOnly;
+
+    JPy_GET_JNI_ENV_OR_RETURN(jenv, -1)
+
+    buf = (*jenv)->GetDirectBufferAddress(jenv, self->objectRef);
+    if (buf == NULL) {
+        PyErr_SetString(PyExc_BufferError, "only direct Java byte buffers can be exported as Python buffers");
+        return -1;
+    }
+
+    capacity = (*jenv)->GetDirectBufferCapacity(jenv, self->objectRef);
+    readOnly = (*jenv)->CallBooleanMethod(jenv, self->objectRef, JPy_Buffer_IsReadOnly_MID);
+    JPy_ON_JAVA_EXCEPTION_RETURN(-1);
+
+    JPy_DIAG_PRINT(JPy_DIAG_F_MEM, "JByteBuffer_getbufferproc: buf=%p, type='%s', capacity=%ld, readOnly=%d\n", buf, Py_TYPE(self)->tp_name, (long) capacity, readOnly);
+
+    // Uses 'view->len' for the shape, so no further allocations are required
+    return PyBuffer_FillInfo(view, (PyObject*) self, buf, (Py_ssize_t) capacity, readOnly, flags);
+}
+
+PyBufferProcs JByteBuffer_as_buffer = {
+    JPY_PY27_OLD_BUFFER_PROCS
+    (getbufferproc) JByteBuffer_getbufferproc,
+    (releasebufferproc) NULL
+};
@@ -26,15 +26,22 @@ extern "C" {
 /**
  * The Java primitive array representation in Python.
  *
- * IMPORTANT: JPy_JArray must only differ from the JPy_JObj structure by the 'bufferExportCount' member
+ * IMPORTANT: JPy_JArray must only differ from the JPy_JObj structure by the trailing buffer members
  * since we use the same basic type, name JPy_JType for it. DON'T ever change member positions!
  * @see JPy_JObj
+ *
+ * All concurrent buffer exports of an array share the same array elements and the embedded
+ * 'bufferShape' and 'bufferStrides', so exporting a buffer doesn't allocate any memory.
+ * The elements are acquired by the first export and released with the last one.
  */
 typedef struct JPy_JArray
 {
     PyObject_HEAD
     jobject objectRef;
     jint bufferExportCount;
+    void* bufferElements;
+    Py_ssize_t bufferShape[1];
+    Py_ssize_t bufferStrides[1];
 }
 JPy_JArray;
 
@@ -47,6 +54,11 @@ extern PyBufferProcs JArray_as_buffer_long;
 extern PyBufferProcs JArray_as_buffer_float;
 extern PyBufferProcs JArray_as_buffer_double;
 
+/**
+ * Buffer protocol of direct java.nio.ByteBuffer objects (including java.nio.MappedByteBuffer).
+ */
+extern PyBufferProcs JByteBuffer_as_buffer;
+
 #ifdef __cplusplus
 }  /* extern "C" */
 #endif
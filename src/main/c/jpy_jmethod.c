@@ -22,6 +22,7 @@
 #include "jpy_jobj.h"
 #include "jpy_jmethod.h"
 #include "jpy_conv.h"
+#include "jpy_async.h"
 #include "jpy_compat.h"
 
 
@@ -268,48 +269,58 @@ PyObject* JMethod_InvokeMethod(JNIEnv* jenv, JPy_JMethod* method, PyObject* pyAr
         JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "JMethod_InvokeMethod: calling static Java method %s#%s\n", declaringClass->javaName, JPy_AS_UTF8(method->name));
 
         if (returnType == JPy_JVoid) {
-            (*jenv)->CallStaticVoidMethodA(jenv, classRef, method->mid, jArgs);
+            JPy_CALL_JAVA((*jenv)->CallStaticVoidMethodA(jenv, classRef, method->mid, jArgs));
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FROM_JVOID();
         } else if (returnType == JPy_JBoolean) {
-            jboolean v = (*jenv)->CallStaticBooleanMethodA(jenv, classRef, method->mid, jArgs);
+            jboolean v;
+            JPy_CALL_JAVA(v = (*jenv)->CallStaticBooleanMethodA(jenv, classRef, method->mid, jArgs));
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FROM_JBOOLEAN(v);
         } else if (returnType == JPy_JChar) {
-            jchar v = (*jenv)->CallStaticCharMethodA(jenv, classRef, method->mid, jArgs);
+            jchar v;
+            JPy_CALL_JAVA(v = (*jenv)->CallStaticCharMethodA(jenv, classRef, method->mid, jArgs));
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FROM_JCHAR(v);
         } else if (returnType == JPy_JByte) {
-            jbyte v = (*jenv)->CallStaticByteMethodA(jenv, classRef, method->mid, jArgs);
+            jbyte v;
+            JPy_CALL_JAVA(v = (*jenv)->CallStaticByteMethodA(jenv, classRef, method->mid, jArgs));
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FROM_JBYTE(v);
         } else if (returnType == JPy_JShort) {
-            jshort v = (*jenv)->CallStaticShortMethodA(jenv, classRef, method->mid, jArgs);
+            jshort v;
+            JPy_CALL_JAVA(v = (*jenv)->CallStaticShortMethodA(jenv, classRef, method->mid, jArgs));
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FROM_JSHORT(v);
         } else if (returnType == JPy_JInt) {
-            jint v = (*jenv)->CallStaticIntMethodA(jenv, classRef, method->mid, jArgs);
+            jint v;
+            JPy_CALL_JAVA(v = (*jenv)->CallStaticIntMethodA(jenv, classRef, method->mid, jArgs));
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FROM_JINT(v);
         } else if (returnType == JPy_JLong) {
-            jlong v = (*jenv)->CallStaticLongMethodA(jenv, classRef, method->mid, jArgs);
+            jlong v;
+            JPy_CALL_JAVA(v = (*jenv)->CallStaticLongMethodA(jenv, classRef, method->mid, jArgs));
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FROM_JLONG(v);
         } else if (returnType == JPy_JFloat) {
-            jfloat v = (*jenv)->CallStaticFloatMethodA(jenv, classRef, method->mid, jArgs);
+            jfloat v;
+            JPy_CALL_JAVA(v = (*jenv)->CallStaticFloatMethodA(jenv, classRef, method->mid, jArgs));
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FROM_JFLOAT(v);
         } else if (returnType == JPy_JDouble) {
-            jdouble v = (*jenv)->CallStaticDoubleMethodA(jenv, classRef, method->mid, jArgs);
+            jdouble v;
+            JPy_CALL_JAVA(v = (*jenv)->CallStaticDoubleMethodA(jenv, classRef, method->mid, jArgs));
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FROM_JDOUBLE(v);
         } else if (returnType == JPy_JString) {
-            jstring v = (*jenv)->CallStaticObjectMethodA(jenv, classRef, method->mid, jArgs);
+            jstring v;
+            JPy_CALL_JAVA(v = (*jenv)->CallStaticObjectMethodA(jenv, classRef, method->mid, jArgs));
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FromJString(jenv, v);
             (*jenv)->DeleteLocalRef(jenv, v);
         } else {
-            jobject v = (*jenv)->CallStaticObjectMethodA(jenv, classRef, method->mid, jArgs);
+            jobject v;
+            JPy_CALL_JAVA(v = (*jenv)->CallStaticObjectMethodA(jenv, classRef, method->mid, jArgs));
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JMethod_FromJObject(jenv, method, pyArgs, jArgs, 0, returnType, v);
             (*jenv)->DeleteLocalRef(jenv, v);
@@ -326,48 +337,58 @@ PyObject* JMethod_InvokeMethod(JNIEnv* jenv, JPy_JMethod* method, PyObject* pyAr
         objectRef = ((JPy_JObj*) self)->objectRef;
 
         if (returnType == JPy_JVoid) {
-            (*jenv)->CallVoidMethodA(jenv, objectRef, method->mid, jArgs);
+            JPy_CALL_JAVA((*jenv)->CallVoidMethodA(jenv, objectRef, method->mid, jArgs));
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FROM_JVOID();
         } else if (returnType == JPy_JBoolean) {
-            jboolean v = (*jenv)->CallBooleanMethodA(jenv, objectRef, method->mid, jArgs);
+            jboolean v;
+            JPy_CALL_JAVA(v = (*jenv)->CallBooleanMethodA(jenv, objectRef, method->mid, jArgs));
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FROM_JBOOLEAN(v);
         } else if (returnType == JPy_JChar) {
-            jchar v = (*jenv)->CallCharMethodA(jenv, objectRef, method->mid, jArgs);
+            jchar v;
+            JPy_CALL_JAVA(v = (*jenv)->CallCharMethodA(jenv, objectRef, method->mid, jArgs));
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FROM_JCHAR(v);
         } else if (returnType == JPy_JByte) {
-            jbyte v = (*jenv)->CallByteMethodA(jenv, objectRef, method->mid, jArgs);
+            jbyte v;
+            JPy_CALL_JAVA(v = (*jenv)->CallByteMethodA(jenv, objectRef, method->mid, jArgs));
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FROM_JBYTE(v);
         } else if (returnType == JPy_JShort) {
-            jshort v = (*jenv)->CallShortMethodA(jenv, objectRef, method->mid, jArgs);
+            jshort v;
+            JPy_CALL_JAVA(v = (*jenv)->CallShortMethodA(jenv, objectRef, method->mid, jArgs));
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FROM_JSHORT(v);
         } else if (returnType == JPy_JInt) {
-            jint v = (*jenv)->CallIntMethodA(jenv, objectRef, method->mid, jArgs);
+            jint v;
+            JPy_CALL_JAVA(v = (*jenv)->CallIntMethodA(jenv, objectRef, method->mid, jArgs));
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FROM_JINT(v);
         } else if (returnType == JPy_JLong) {
-            jlong v = (*jenv)->CallLongMethodA(jenv, objectRef, method->mid, jArgs);
+            jlong v;
+            JPy_CALL_JAVA(v = (*jenv)->CallLongMethodA(jenv, objectRef, method->mid, jArgs));
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FROM_JLONG(v);
         } else if (returnType == JPy_JFloat) {
-            jfloat v = (*jenv)->CallFloatMethodA(jenv, objectRef, method->mid, jArgs);
+            jfloat v;
+            JPy_CALL_JAVA(v = (*jenv)->CallFloatMethodA(jenv, objectRef, method->mid, jArgs));
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FROM_JFLOAT(v);
         } else if (returnType == JPy_JDouble) {
-            jdouble v = (*jenv)->CallDoubleMethodA(jenv, objectRef, method->mid, jArgs);
+            jdouble v;
+            JPy_CALL_JAVA(v = (*jenv)->CallDoubleMethodA(jenv, objectRef, method->mid, jArgs));
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FROM_JDOUBLE(v);
         } else if (returnType == JPy_JString) {
-            jstring v = (*jenv)->CallObjectMethodA(jenv, objectRef, method->mid, jArgs);
+            jstring v;
+            JPy_CALL_JAVA(v = (*jenv)->CallObjectMethodA(jenv, objectRef, method->mid, jArgs));
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JPy_FromJString(jenv, v);
             (*jenv)->DeleteLocalRef(jenv, v);
         } else {
-            jobject v = (*jenv)->CallObjectMethodA(jenv, objectRef, method->mid, jArgs);
+            jobject v;
+            JPy_CALL_JAVA(v = (*jenv)->CallObjectMethodA(jenv, objectRef, method->mid, jArgs));
             JPy_ON_JAVA_EXCEPTION_GOTO(error);
             returnValue = JMethod_FromJObject(jenv, method, pyArgs, jArgs, 1, returnType, v);
             (*jenv)->DeleteLocalRef(jenv, v);
@@ -25,6 +25,7 @@
 #include "jpy_jmethod.h"
 #include "jpy_jfield.h"
 #include "jpy_conv.h"
+#include "jpy_async.h"
 
 PyObject* JObj_New(JNIEnv* jenv, jobject objectRef)
 {
@@ -67,20 +68,23 @@ PyObject* JObj_FromType(JNIEnv* jenv, JPy_JType* type, jobject objectRef)
 
         array = (JPy_JArray*) obj;
         array->bufferExportCount = 0;
+        array->bufferElements = NULL;
     }
 
     // we check the type translations dictionary for a callable for this java type name,
     // and apply the returned callable to the wrapped object
-    callable = PyDict_GetItemString(JPy_Type_Translations, type->javaName);
+    callable = JPy_GetDictItemStringRef(JPy_Type_Translations, type->javaName);
     if (callable != NULL) {
         if (PyCallable_Check(callable)) {
             callableResult = PyObject_CallFunction(callable, "OO", type, obj);
+            Py_DECREF(callable);
             if (callableResult == NULL) {
                 return Py_None;
             } else {
                 return callableResult;
             }
         }
+        Py_DECREF(callable);
     }
 
     return (PyObject *)obj;
@@ -133,7 +137,7 @@ int JObj_init(JPy_JObj* self, PyObject* args, PyObject* kwds)
 
     JPy_DIAG_PRINT(JPy_DIAG_F_MEM, "JObj_init: calling Java constructor %s\n", jType->javaName);
 
-    objectRef = (*jenv)->NewObjectA(jenv, jType->classRef, jMethod->mid, jArgs);
+    JPy_CALL_JAVA(objectRef = (*jenv)->NewObjectA(jenv, jType->classRef, jMethod->mid, jArgs));
     JPy_ON_JAVA_EXCEPTION_RETURN(-1);
 
     if (objectRef == NULL) {
@@ -690,20 +694,21 @@ static PySequenceMethods JObj_as_sequence = {
 };
 
 
-int JType_InitSlots(JPy_JType* type)
+int JType_InitSlots(JNIEnv* jenv, JPy_JType* type)
 {
     PyTypeObject* typeObj;
     jboolean isArray;
     jboolean isPrimitiveArray;
+    jboolean isByteBuffer;
 
     isArray = type->componentType != NULL;
     isPrimitiveArray = isArray && type->componentType->isPrimitive;
 
     typeObj = (PyTypeObject*) type;
 
-    Py_REFCNT(typeObj) = 1;
-    Py_TYPE(typeObj) = NULL;
-    Py_SIZE(typeObj) = 0;
+    Py_SET_REFCNT(typeObj, 1);
+    Py_SET_TYPE(typeObj, NULL);
+    Py_SET_SIZE(typeObj, 0);
     // todo: The following lines are actually correct, but setting Py_TYPE(type) = &JType_Type results in an interpreter crash. Why?
     // This is still a problem because all the JType slots are actually never called (especially JType_getattro is
     // needed to resolve unresolved JTypes and to recognize static field and methods access)
@@ -720,8 +725,14 @@ int JType_InitSlots(JPy_JType* type)
     // (see also http://stackoverflow.com/questions/8066438/how-to-dynamically-create-a-derived-type-in-the-python-c-api)
     //typeObj->tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_HEAPTYPE;
 
+    // java.nio.ByteBuffer and all of its subclasses (e.g. MappedByteBuffer and the JDK's DirectByteBuffer)
+    // export their memory, if direct, via the buffer protocol. Static types don't inherit tp_as_buffer,
+    // hence the check against the super type.
+    isByteBuffer = strcmp(type->javaName, "java.nio.ByteBuffer") == 0
+                   || (type->superType != NULL && ((PyTypeObject*) type->superType)->tp_as_buffer == &JByteBuffer_as_buffer);
+
     #if defined(JPY_COMPAT_27)
-    if (isPrimitiveArray) {
+    if (isPrimitiveArray || isByteBuffer) {
         typeObj->tp_flags |= Py_TPFLAGS_HAVE_NEWBUFFER;
     }
     #endif
@@ -763,6 +774,18 @@ int JType_InitSlots(JPy_JType* type)
         }
     }
 
+    if (isByteBuffer) {
+        typeObj->tp_as_buffer = &JByteBuffer_as_buffer;
+    }
+
+    #if defined(JPY_COMPAT_35P)
+    // java.util.concurrent.CompletionStage and Future objects can be awaited in coroutines.
+    // Interfaces are not in the tp_base chain, hence the check of each type.
+    if (JAsync_IsAwaitableType(jenv, type)) {
+        typeObj->tp_as_async = &JObj_as_async;
+    }
+    #endif
+
     //printf("JType_InitSlots: typeObj->tp_as_buffer=%p\n", typeObj->tp_as_buffer);
 
     typeObj->tp_alloc = PyType_GenericAlloc;
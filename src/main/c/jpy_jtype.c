@@ -28,7 +28,10 @@
 
 
 JPy_JType* JType_New(JNIEnv* jenv, jclass classRef, jboolean resolve);
+JPy_JType* JType_GetTypeLocked(JNIEnv* jenv, jclass classRef, jboolean resolve);
 int JType_ResolveType(JNIEnv* jenv, JPy_JType* type);
+int JType_ResolveTypeOnce(JNIEnv* jenv, JPy_JType* type, jboolean mayWait);
+int JType_ResolveTypeLocked(JNIEnv* jenv, JPy_JType* type, jboolean mayWait);
 int JType_InitComponentType(JNIEnv* jenv, JPy_JType* type, jboolean resolve);
 int JType_InitSuperType(JNIEnv* jenv, JPy_JType* type, jboolean resolve);
 int JType_ProcessClassConstructors(JNIEnv* jenv, JPy_JType* type);
@@ -37,12 +40,15 @@ int JType_ProcessClassMethods(JNIEnv* jenv, JPy_JType* type);
 int JType_AddMethod(JPy_JType* type, JPy_JMethod* method);
 JPy_ReturnDescriptor* JType_CreateReturnDescriptor(JNIEnv* jenv, jclass returnType);
 JPy_ParamDescriptor* JType_CreateParamDescriptors(JNIEnv* jenv, int paramCount, jarray paramTypes);
+jobjectArray JType_GetParamAnnotationFlags(JNIEnv* jenv, jobjectArray members);
+void JType_ApplyParamAnnotationFlags(JNIEnv* jenv, JPy_JMethod* method, jintArray paramFlags);
 void JType_InitParamDescriptorFunctions(JPy_ParamDescriptor* paramDescriptor, jboolean isLastVarArg);
 void JType_InitMethodParamDescriptorFunctions(JPy_JType* type, JPy_JMethod* method);
 int JType_ProcessField(JNIEnv* jenv, JPy_JType* declaringType, PyObject* fieldKey, const char* fieldName, jclass fieldClassRef, jboolean isStatic, jboolean isFinal, jfieldID fid);
 void JType_DisposeLocalObjectRefArg(JNIEnv* jenv, jvalue* value, void* data);
 void JType_DisposeReadOnlyBufferArg(JNIEnv* jenv, jvalue* value, void* data);
 void JType_DisposeWritableBufferArg(JNIEnv* jenv, jvalue* value, void* data);
+Py_ssize_t JType_CopyBackChangedChunks(char* dst, const char* src, Py_ssize_t len);
 
 
 static int JType_MatchVarArgPyArgAsFPType(const JPy_ParamDescriptor *paramDescriptor, PyObject *pyArg, int idx,
@@ -127,10 +133,41 @@ JPy_JType* JType_GetTypeForName(JNIEnv* jenv, const char* typeName, jboolean res
     return JType_GetType(jenv, classRef, resolve);
 }
 
+/**
+ * The depth of nested type creations and resolutions in the current thread, e.g. when the values of
+ * static fields of the type being resolved require other types. While greater than zero, the thread must
+ * not wait for types being resolved by other threads, as these could be waiting for the current thread.
+ */
+static JPy_THREAD_LOCAL int JType_NestingDepth = 0;
+
 /**
  * Returns a new reference.
  */
 JPy_JType* JType_GetType(JNIEnv* jenv, jclass classRef, jboolean resolve)
+{
+    JPy_JType* type;
+
+    // New types are registered in JPy_Types before they are complete, so in free-threaded Python builds
+    // other threads must wait until the type is complete.
+    // The type is resolved after the lock is released, resolving may have to wait for other threads.
+    JPy_BEGIN_GLOBALS_LOCK
+    JType_NestingDepth++;
+    type = JType_GetTypeLocked(jenv, classRef, resolve);
+    JType_NestingDepth--;
+    JPy_END_GLOBALS_LOCK
+
+    if (type != NULL && resolve) {
+        if (JType_ResolveType(jenv, type) < 0
+            || (type->componentType != NULL && JType_ResolveType(jenv, type->componentType) < 0)) {
+            Py_DECREF(type);
+            return NULL;
+        }
+    }
+
+    return type;
+}
+
+JPy_JType* JType_GetTypeLocked(JNIEnv* jenv, jclass classRef, jboolean resolve)
 {
     PyObject* typeKey;
     PyObject* typeValue;
@@ -167,7 +204,7 @@ JPy_JType* JType_GetType(JNIEnv* jenv, jclass classRef, jboolean resolve)
         //printf("T2: type->tp_init=%p\n", ((PyTypeObject*)type)->tp_init);
 
         // ... before we can continue processing the super type ...
-        if (JType_InitSuperType(jenv, type, resolve) < 0) {
+        if (JType_InitSuperType(jenv, type, JNI_FALSE) < 0) {
             PyDict_DelItem(JPy_Types, typeKey);
             return NULL;
         }
@@ -175,7 +212,7 @@ JPy_JType* JType_GetType(JNIEnv* jenv, jclass classRef, jboolean resolve)
         //printf("T3: type->tp_init=%p\n", ((PyTypeObject*)type)->tp_init);
 
         // ... and processing the component type.
-        if (JType_InitComponentType(jenv, type, resolve) < 0) {
+        if (JType_InitComponentType(jenv, type, JNI_FALSE) < 0) {
             PyDict_DelItem(JPy_Types, typeKey);
             return NULL;
         }
@@ -183,7 +220,7 @@ JPy_JType* JType_GetType(JNIEnv* jenv, jclass classRef, jboolean resolve)
         //printf("T4: type->tp_init=%p\n", ((PyTypeObject*)type)->tp_init);
 
         // Finally we initialise the type's slots, so that our JObj instances behave pythonic.
-        if (JType_InitSlots(type) < 0) {
+        if (JType_InitSlots(jenv, type) < 0) {
             JPy_DIAG_PRINT(JPy_DIAG_F_TYPE, "JType_GetType: error: JType_InitSlots() failed for javaName=\"%s\"\n", type->javaName);
             PyDict_DelItem(JPy_Types, typeKey);
             return NULL;
@@ -217,12 +254,6 @@ JPy_JType* JType_GetType(JNIEnv* jenv, jclass classRef, jboolean resolve)
 
     JPy_DIAG_PRINT(JPy_DIAG_F_TYPE, "JType_GetType: javaName=\"%s\", found=%d, resolve=%d, resolved=%d, type=%p\n", type->javaName, found, resolve, type->isResolved, type);
 
-    if (!type->isResolved && resolve) {
-        if (JType_ResolveType(jenv, type) < 0) {
-            return NULL;
-        }
-    }
-    
     Py_INCREF(type);
     return type;
 }
@@ -247,10 +278,18 @@ JPy_JType* JType_New(JNIEnv* jenv, jclass classRef, jboolean resolve)
 
     type->classRef = NULL;
     type->isResolved = JNI_FALSE;
-    type->isResolving = JNI_FALSE;
+    type->resolvingThread = 0;
+
+    type->resolveLock = PyThread_allocate_lock();
+    if (type->resolveLock == NULL) {
+        metaType->tp_free(type);
+        PyErr_NoMemory();
+        return NULL;
+    }
 
     type->javaName = JPy_GetTypeName(jenv, classRef);
     if (type->javaName == NULL) {
+        PyThread_free_lock(type->resolveLock);
         metaType->tp_free(type);
         return NULL;
     }
@@ -263,6 +302,7 @@ JPy_JType* JType_New(JNIEnv* jenv, jclass classRef, jboolean resolve)
     if (type->classRef == NULL) {
         PyMem_Del(type->javaName);
         type->javaName = NULL;
+        PyThread_free_lock(type->resolveLock);
         metaType->tp_free(type);
         PyErr_NoMemory();
         return NULL;
@@ -306,6 +346,7 @@ PyObject* JType_ConvertJavaToPythonObject(JNIEnv* jenv, JPy_JType* type, jobject
             return JPy_FROM_JDOUBLE(value);
         } else if (type == JPy_JPyObject || type == JPy_JPyModule) {
             jlong value = (*jenv)->CallLongMethod(jenv, objectRef, JPy_PyObject_GetPointer_MID);
+            JPy_ON_JAVA_EXCEPTION_RETURN(NULL);
             return (PyObject*) value;
         } else if (type == JPy_JString) {
             return JPy_FromJString(jenv, objectRef);
@@ -450,6 +491,7 @@ int JType_CreateJavaPyObject(JNIEnv* jenv, JPy_JType* type, PyObject* pyArg, job
 
 int JType_CreateJavaArray(JNIEnv* jenv, JPy_JType* componentType, PyObject* pyArg, jobject* objectRef, jboolean allowObjectWrapping)
 {
+    Py_ssize_t seqLength;
     jint itemCount;
     jarray arrayRef;
     jint index;
@@ -458,10 +500,16 @@ int JType_CreateJavaArray(JNIEnv* jenv, JPy_JType* componentType, PyObject* pyAr
     if (pyArg == Py_None) {
         itemCount = 0;
     } else if (PySequence_Check(pyArg)) {
-        itemCount = PySequence_Length(pyArg);
-        if (itemCount < 0) {
+        seqLength = PySequence_Length(pyArg);
+        if (seqLength < 0) {
+            return -1;
+        }
+        if (seqLength > JPy_MAX_ARRAY_LENGTH) {
+            PyErr_Format(PyExc_ValueError, "cannot convert a Python sequence of length %ld to a Java array, the maximum Java array length is %ld",
+                         (long) seqLength, (long) JPy_MAX_ARRAY_LENGTH);
             return -1;
         }
+        itemCount = (jint) seqLength;
     } else {
         PyErr_Format(PyExc_ValueError, "cannot convert a Python '%s' to a Java array of type '%s'", Py_TYPE(pyArg)->tp_name, componentType->javaName);
         return -1;
@@ -745,6 +793,107 @@ int JType_CreateJavaArray(JNIEnv* jenv, JPy_JType* componentType, PyObject* pyAr
     return 0;
 }
 
+/**
+ * Returns the size in bytes of the items of a Java primitive array with the given component type, or 0 if
+ * componentType is not a primitive type.
+ */
+size_t JType_GetPrimitiveItemSize(JPy_JType* componentType)
+{
+    if (componentType == JPy_JBoolean) {
+        return sizeof(jboolean);
+    } else if (componentType == JPy_JByte) {
+        return sizeof(jbyte);
+    } else if (componentType == JPy_JChar) {
+        return sizeof(jchar);
+    } else if (componentType == JPy_JShort) {
+        return sizeof(jshort);
+    } else if (componentType == JPy_JInt) {
+        return sizeof(jint);
+    } else if (componentType == JPy_JLong) {
+        return sizeof(jlong);
+    } else if (componentType == JPy_JFloat) {
+        return sizeof(jfloat);
+    } else if (componentType == JPy_JDouble) {
+        return sizeof(jdouble);
+    }
+    return 0;
+}
+
+/**
+ * Creates a new Java primitive array. Returns a local reference or NULL, if componentType is not
+ * a primitive type or if a Java exception occurred.
+ */
+jarray JType_NewPrimitiveArray(JNIEnv* jenv, JPy_JType* componentType, jsize length)
+{
+    if (componentType == JPy_JBoolean) {
+        return (*jenv)->NewBooleanArray(jenv, length);
+    } else if (componentType == JPy_JByte) {
+        return (*jenv)->NewByteArray(jenv, length);
+    } else if (componentType == JPy_JChar) {
+        return (*jenv)->NewCharArray(jenv, length);
+    } else if (componentType == JPy_JShort) {
+        return (*jenv)->NewShortArray(jenv, length);
+    } else if (componentType == JPy_JInt) {
+        return (*jenv)->NewIntArray(jenv, length);
+    } else if (componentType == JPy_JLong) {
+        return (*jenv)->NewLongArray(jenv, length);
+    } else if (componentType == JPy_JFloat) {
+        return (*jenv)->NewFloatArray(jenv, length);
+    } else if (componentType == JPy_JDouble) {
+        return (*jenv)->NewDoubleArray(jenv, length);
+    }
+    return NULL;
+}
+
+/**
+ * Copies 'length' items from 'items' into the Java primitive array, starting at index 'start'.
+ * Other than Get<Type>ArrayElements(), this neither pins nor copies the whole Java array.
+ */
+void JType_SetPrimitiveArrayRegion(JNIEnv* jenv, JPy_JType* componentType, jarray arrayRef, jsize start, jsize length, const void* items)
+{
+    if (componentType == JPy_JBoolean) {
+        (*jenv)->SetBooleanArrayRegion(jenv, arrayRef, start, length, (const jboolean*) items);
+    } else if (componentType == JPy_JByte) {
+        (*jenv)->SetByteArrayRegion(jenv, arrayRef, start, length, (const jbyte*) items);
+    } else if (componentType == JPy_JChar) {
+        (*jenv)->SetCharArrayRegion(jenv, arrayRef, start, length, (const jchar*) items);
+    } else if (componentType == JPy_JShort) {
+        (*jenv)->SetShortArrayRegion(jenv, arrayRef, start, length, (const jshort*) items);
+    } else if (componentType == JPy_JInt) {
+        (*jenv)->SetIntArrayRegion(jenv, arrayRef, start, length, (const jint*) items);
+    } else if (componentType == JPy_JLong) {
+        (*jenv)->SetLongArrayRegion(jenv, arrayRef, start, length, (const jlong*) items);
+    } else if (componentType == JPy_JFloat) {
+        (*jenv)->SetFloatArrayRegion(jenv, arrayRef, start, length, (const jfloat*) items);
+    } else if (componentType == JPy_JDouble) {
+        (*jenv)->SetDoubleArrayRegion(jenv, arrayRef, start, length, (const jdouble*) items);
+    }
+}
+
+/**
+ * Copies 'length' items of the Java primitive array, starting at index 'start', into 'items'.
+ */
+void JType_GetPrimitiveArrayRegion(JNIEnv* jenv, JPy_JType* componentType, jarray arrayRef, jsize start, jsize length, void* items)
+{
+    if (componentType == JPy_JBoolean) {
+        (*jenv)->GetBooleanArrayRegion(jenv, arrayRef, start, length, (jboolean*) items);
+    } else if (componentType == JPy_JByte) {
+        (*jenv)->GetByteArrayRegion(jenv, arrayRef, start, length, (jbyte*) items);
+    } else if (componentType == JPy_JChar) {
+        (*jenv)->GetCharArrayRegion(jenv, arrayRef, start, length, (jchar*) items);
+    } else if (componentType == JPy_JShort) {
+        (*jenv)->GetShortArrayRegion(jenv, arrayRef, start, length, (jshort*) items);
+    } else if (componentType == JPy_JInt) {
+        (*jenv)->GetIntArrayRegion(jenv, arrayRef, start, length, (jint*) items);
+    } else if (componentType == JPy_JLong) {
+        (*jenv)->GetLongArrayRegion(jenv, arrayRef, start, length, (jlong*) items);
+    } else if (componentType == JPy_JFloat) {
+        (*jenv)->GetFloatArrayRegion(jenv, arrayRef, start, length, (jfloat*) items);
+    } else if (componentType == JPy_JDouble) {
+        (*jenv)->GetDoubleArrayRegion(jenv, arrayRef, start, length, (jdouble*) items);
+    }
+}
+
 int JType_ConvertPythonToJavaObject(JNIEnv* jenv, JPy_JType* type, PyObject* pyArg, jobject* objectRef, jboolean allowObjectWrapping)
 {
     // Note: There may be a potential memory leak here.
@@ -811,49 +960,106 @@ int JType_ConvertPythonToJavaObject(JNIEnv* jenv, JPy_JType* type, PyObject* pyA
  * Fill the type __dict__ with our Java class constructors and methods.
  * Constructors will be available using the key named __jinit__.
  * Methods will be available using their method name.
+ *
+ * Each type is resolved once: threads that find the type being resolved by another thread wait
+ * until it is complete, so that they never see a partially filled __dict__.
  */
 int JType_ResolveType(JNIEnv* jenv, JPy_JType* type)
 {
-    PyTypeObject* typeObj;
+    // A thread resolving a type must not wait for other types: the other thread could be waiting for
+    // the type we are resolving. Only a top-level resolution may wait, see JType_ResolveTypeLocked().
+    return JType_ResolveTypeOnce(jenv, type, JType_NestingDepth == 0);
+}
 
-    if (type->isResolved || type->isResolving) {
+int JType_ResolveTypeOnce(JNIEnv* jenv, JPy_JType* type, jboolean mayWait)
+{
+    unsigned long thread;
+    int result;
+
+    if (type->isResolved) {
         return 0;
     }
 
-    type->isResolving = JNI_TRUE;
+    // Recursive resolution by the resolving thread itself, e.g. for a method returning its declaring type
+    thread = PyThread_get_thread_ident();
+    if (type->resolvingThread == thread) {
+        return 0;
+    }
+
+    // Types not created by JType_New() have no lock and are resolved unsynchronised
+    if (type->resolveLock != NULL && !PyThread_acquire_lock(type->resolveLock, NOWAIT_LOCK)) {
+        if (!mayWait) {
+            JPy_DIAG_PRINT(JPy_DIAG_F_TYPE, "JType_ResolveType: type '%s' is being resolved by another thread, not waiting\n", type->javaName);
+            return 0;
+        }
+        Py_BEGIN_ALLOW_THREADS
+        PyThread_acquire_lock(type->resolveLock, WAIT_LOCK);
+        Py_END_ALLOW_THREADS
+    }
+
+    // Another thread may have completed the resolution while we were waiting
+    result = 0;
+    if (!type->isResolved) {
+        type->resolvingThread = thread;
+        JType_NestingDepth++;
+        result = JType_ResolveTypeLocked(jenv, type, mayWait);
+        JType_NestingDepth--;
+        if (result == 0) {
+            type->isResolved = JNI_TRUE;
+        } else if (result > 0) {
+            // Deferred, the type is resolved lazily on its next attribute access
+            result = 0;
+        }
+        type->resolvingThread = 0;
+    }
+
+    if (type->resolveLock != NULL) {
+        PyThread_release_lock(type->resolveLock);
+    }
+    return result;
+}
+
+/**
+ * Resolves the type while holding its resolve lock. Returns 0 on success, -1 on error, or 1 if the
+ * resolution has been deferred because the base type is being resolved by another thread.
+ *
+ * Base types are resolved first. Only a top-level resolution ('mayWait') waits for them: its thread then
+ * holds no other locks than those of the subtypes along the same base type chain, so that all blocking
+ * waits acquire locks from subtypes to base types, i.e. in the same global order. A nested resolution
+ * must not wait for the base type, the thread resolving it could be waiting for a type we hold.
+ */
+int JType_ResolveTypeLocked(JNIEnv* jenv, JPy_JType* type, jboolean mayWait)
+{
+    PyTypeObject* typeObj;
 
     typeObj = (PyTypeObject*) type;
     if (typeObj->tp_base != NULL && JType_Check((PyObject*) typeObj->tp_base)) {
         JPy_JType* baseType = (JPy_JType*) typeObj->tp_base;
-        if (!baseType->isResolved) {
-            if (JType_ResolveType(jenv, baseType) < 0) {
-                type->isResolving = JNI_FALSE;
-                return -1;
-            }
+        if (JType_ResolveTypeOnce(jenv, baseType, mayWait) < 0) {
+            return -1;
+        }
+        if (!baseType->isResolved && baseType->resolvingThread != PyThread_get_thread_ident()) {
+            JPy_DIAG_PRINT(JPy_DIAG_F_TYPE, "JType_ResolveType: base type of '%s' is being resolved by another thread, deferring\n", type->javaName);
+            return 1;
         }
     }
 
     //printf("JType_ResolveType 1\n");
     if (JType_ProcessClassConstructors(jenv, type) < 0) {
-        type->isResolving = JNI_FALSE;
         return -1;
     }
 
     //printf("JType_ResolveType 2\n");
     if (JType_ProcessClassMethods(jenv, type) < 0) {
-        type->isResolving = JNI_FALSE;
         return -1;
     }
 
     //printf("JType_ResolveType 3\n");
     if (JType_ProcessClassFields(jenv, type) < 0) {
-        type->isResolving = JNI_FALSE;
         return -1;
     }
 
     //printf("JType_ResolveType 4\n");
-    type->isResolving = JNI_FALSE;
-    type->isResolved = JNI_TRUE;
     return 0;
 }
 
@@ -864,24 +1070,26 @@ jboolean JType_AcceptMethod(JPy_JType* declaringClass, JPy_JMethod* method)
 
     //printf("JType_AcceptMethod: javaName='%s'\n", overloadedMethod->declaringClass->javaName);
 
-    callable = PyDict_GetItemString(JPy_Type_Callbacks, declaringClass->javaName);
+    callable = JPy_GetDictItemStringRef(JPy_Type_Callbacks, declaringClass->javaName);
     if (callable != NULL) {
         if (PyCallable_Check(callable)) {
             callableResult = PyObject_CallFunction(callable, "OO", declaringClass, method);
             if (callableResult == Py_None || callableResult == Py_False) {
+                Py_DECREF(callable);
                 return JNI_FALSE;
             } else if (callableResult == NULL) {
                 JPy_DIAG_PRINT(JPy_DIAG_F_TYPE, "JType_AcceptMethod: warning: failed to invoke callback on method addition\n");
                 // Ignore this problem and continue
             }
         }
+        Py_DECREF(callable);
     }
 
     return JNI_TRUE;
 }
 
 
-int JType_ProcessMethod(JNIEnv* jenv, JPy_JType* type, PyObject* methodKey, const char* methodName, jclass returnType, jarray paramTypes, jboolean isStatic, jboolean isVarArgs, jmethodID mid)
+int JType_ProcessMethod(JNIEnv* jenv, JPy_JType* type, PyObject* methodKey, const char* methodName, jclass returnType, jarray paramTypes, jintArray paramFlags, jboolean isStatic, jboolean isVarArgs, jmethodID mid)
 {
     JPy_ParamDescriptor* paramDescriptors = NULL;
     JPy_ReturnDescriptor* returnDescriptor = NULL;
@@ -920,6 +1128,11 @@ int JType_ProcessMethod(JNIEnv* jenv, JPy_JType* type, PyObject* methodKey, cons
         return -1;
     }
 
+    // Apply @Mutable, @Output, @Return before the type callbacks run, so that callbacks can still override them
+    if (paramFlags != NULL) {
+        JType_ApplyParamAnnotationFlags(jenv, method, paramFlags);
+    }
+
     if (JType_AcceptMethod(type, method)) {
         JType_InitMethodParamDescriptorFunctions(type, method);
         JType_AddMethod(type, method);
@@ -978,6 +1191,8 @@ int JType_ProcessClassConstructors(JNIEnv* jenv, JPy_JType* type)
     jobject constructors;
     jobject constructor;
     jobject parameterTypes;
+    jobjectArray paramFlagsArray;
+    jintArray paramFlags;
     jint modifiers;
     jint constrCount;
     jint i;
@@ -990,8 +1205,9 @@ int JType_ProcessClassConstructors(JNIEnv* jenv, JPy_JType* type)
     methodKey = Py_BuildValue("s", JPy_JTYPE_ATTR_NAME_JINIT);
     constructors = (*jenv)->CallObjectMethod(jenv, classRef, JPy_Class_GetDeclaredConstructors_MID);
     constrCount = (*jenv)->GetArrayLength(jenv, constructors);
+    paramFlagsArray = JType_GetParamAnnotationFlags(jenv, constructors);
 
-    JPy_DIAG_PRINT(JPy_DIAG_F_TYPE, "JType_ProcessClassConstructors: constrCount=%d\n", constrCount);
+    JPy_DIAG_PRINT(JPy_DIAG_F_TYPE, "JType_ProcessClassConstructors: constrCount=%d, paramFlagsArray=%p\n", constrCount, paramFlagsArray);
 
     for (i = 0; i < constrCount; i++) {
         constructor = (*jenv)->GetObjectArrayElement(jenv, constructors, i);
@@ -1000,13 +1216,20 @@ int JType_ProcessClassConstructors(JNIEnv* jenv, JPy_JType* type)
         isVarArg = (modifiers & 0x0080) != 0;
         if (isPublic) {
             parameterTypes = (*jenv)->CallObjectMethod(jenv, constructor, JPy_Constructor_GetParameterTypes_MID);
+            paramFlags = paramFlagsArray != NULL ? (*jenv)->GetObjectArrayElement(jenv, paramFlagsArray, i) : NULL;
             mid = (*jenv)->FromReflectedMethod(jenv, constructor);
-            JType_ProcessMethod(jenv, type, methodKey, JPy_JTYPE_ATTR_NAME_JINIT, NULL, parameterTypes, 1, isVarArg, mid);
+            JType_ProcessMethod(jenv, type, methodKey, JPy_JTYPE_ATTR_NAME_JINIT, NULL, parameterTypes, paramFlags, 1, isVarArg, mid);
+            if (paramFlags != NULL) {
+                (*jenv)->DeleteLocalRef(jenv, paramFlags);
+            }
             (*jenv)->DeleteLocalRef(jenv, parameterTypes);
         }
         (*jenv)->DeleteLocalRef(jenv, constructor);
     }
 
+    if (paramFlagsArray != NULL) {
+        (*jenv)->DeleteLocalRef(jenv, paramFlagsArray);
+    }
     (*jenv)->DeleteLocalRef(jenv, constructors);
 
     return 0;
@@ -1074,6 +1297,8 @@ int JType_ProcessClassMethods(JNIEnv* jenv, JPy_JType* type)
     jobject methodNameStr;
     jobject returnType;
     jobject parameterTypes;
+    jobjectArray paramFlagsArray;
+    jintArray paramFlags;
     jint modifiers;
     jint methodCount;
     jint i;
@@ -1089,8 +1314,9 @@ int JType_ProcessClassMethods(JNIEnv* jenv, JPy_JType* type)
 
     methods = (*jenv)->CallObjectMethod(jenv, classRef, JPy_Class_GetMethods_MID);
     methodCount = (*jenv)->GetArrayLength(jenv, methods);
+    paramFlagsArray = JType_GetParamAnnotationFlags(jenv, methods);
 
-    JPy_DIAG_PRINT(JPy_DIAG_F_TYPE, "JType_ProcessClassMethods: methodCount=%d\n", methodCount);
+    JPy_DIAG_PRINT(JPy_DIAG_F_TYPE, "JType_ProcessClassMethods: methodCount=%d, paramFlagsArray=%p\n", methodCount, paramFlagsArray);
 
     for (i = 0; i < methodCount; i++) {
         method = (*jenv)->GetObjectArrayElement(jenv, methods, i);
@@ -1105,23 +1331,92 @@ int JType_ProcessClassMethods(JNIEnv* jenv, JPy_JType* type)
             methodNameStr = (*jenv)->CallObjectMethod(jenv, method, JPy_Method_GetName_MID);
             returnType = (*jenv)->CallObjectMethod(jenv, method, JPy_Method_GetReturnType_MID);
             parameterTypes = (*jenv)->CallObjectMethod(jenv, method, JPy_Method_GetParameterTypes_MID);
+            paramFlags = paramFlagsArray != NULL ? (*jenv)->GetObjectArrayElement(jenv, paramFlagsArray, i) : NULL;
             mid = (*jenv)->FromReflectedMethod(jenv, method);
 
             methodName = (*jenv)->GetStringUTFChars(jenv, methodNameStr, NULL);
             methodKey = Py_BuildValue("s", methodName);
-            JType_ProcessMethod(jenv, type, methodKey, methodName, returnType, parameterTypes, isStatic, isVarArg, mid);
+            JType_ProcessMethod(jenv, type, methodKey, methodName, returnType, parameterTypes, paramFlags, isStatic, isVarArg, mid);
             (*jenv)->ReleaseStringUTFChars(jenv, methodNameStr, methodName);
 
+            if (paramFlags != NULL) {
+                (*jenv)->DeleteLocalRef(jenv, paramFlags);
+            }
             (*jenv)->DeleteLocalRef(jenv, parameterTypes);
             (*jenv)->DeleteLocalRef(jenv, returnType);
             (*jenv)->DeleteLocalRef(jenv, methodNameStr);
         }
         (*jenv)->DeleteLocalRef(jenv, method);
     }
+    if (paramFlagsArray != NULL) {
+        (*jenv)->DeleteLocalRef(jenv, paramFlagsArray);
+    }
     (*jenv)->DeleteLocalRef(jenv, methods);
     return 0;
 }
 
+/**
+ * Reads the org.jpy.annotations parameter annotations of all given methods or constructors in a single JNI call.
+ * Returns a local reference to an int[][] with one (possibly null) flags array per member, or NULL if
+ * the annotations are not available or if no parameter of any member is annotated.
+ */
+jobjectArray JType_GetParamAnnotationFlags(JNIEnv* jenv, jobjectArray members)
+{
+    jobjectArray paramFlagsArray;
+
+    if (JPy_ParamAnnotations_JClass == NULL || members == NULL) {
+        return NULL;
+    }
+
+    paramFlagsArray = (*jenv)->CallStaticObjectMethod(jenv, JPy_ParamAnnotations_JClass, JPy_ParamAnnotations_GetFlags_MID, members);
+    if ((*jenv)->ExceptionCheck(jenv)) {
+        // Annotations are only hints, so never fail type resolution because of them
+        JPy_DIAG_PRINT(JPy_DIAG_F_TYPE + JPy_DIAG_F_ERR, "JType_GetParamAnnotationFlags: WARNING: failed to read parameter annotations\n");
+        (*jenv)->ExceptionClear(jenv);
+        return NULL;
+    }
+
+    return paramFlagsArray;
+}
+
+/**
+ * Sets the isMutable, isOutput and isReturn parameter descriptor flags of the given method
+ * from the flags array computed by org.jpy.annotations.ParamAnnotations.
+ */
+void JType_ApplyParamAnnotationFlags(JNIEnv* jenv, JPy_JMethod* method, jintArray paramFlags)
+{
+    JPy_ParamDescriptor* paramDescriptor;
+    jint* flags;
+    int i;
+
+    if ((*jenv)->GetArrayLength(jenv, paramFlags) != method->paramCount) {
+        return;
+    }
+
+    flags = (*jenv)->GetIntArrayElements(jenv, paramFlags, NULL);
+    if (flags == NULL) {
+        return;
+    }
+
+    for (i = 0; i < method->paramCount; i++) {
+        paramDescriptor = method->paramDescriptors + i;
+        paramDescriptor->isMutable = (flags[i] & JPy_PARAM_FLAG_MUTABLE) != 0;
+        paramDescriptor->isOutput = (flags[i] & JPy_PARAM_FLAG_OUTPUT) != 0;
+        // Only object parameters of methods returning an object can be returned as-is
+        if ((flags[i] & JPy_PARAM_FLAG_RETURN) != 0
+            && method->returnDescriptor != NULL
+            && !method->returnDescriptor->type->isPrimitive
+            && !paramDescriptor->type->isPrimitive) {
+            paramDescriptor->isReturn = 1;
+            method->returnDescriptor->paramIndex = i;
+        }
+        JPy_DIAG_PRINT(JPy_DIAG_F_TYPE, "JType_ApplyParamAnnotationFlags: method '%s', param %d: isMutable=%d, isOutput=%d, isReturn=%d\n",
+                       JPy_AS_UTF8(method->name), i, paramDescriptor->isMutable, paramDescriptor->isOutput, paramDescriptor->isReturn);
+    }
+
+    (*jenv)->ReleaseIntArrayElements(jenv, paramFlags, flags, JNI_ABORT);
+}
+
 jboolean JType_AcceptField(JPy_JType* declaringClass, JPy_JField* field)
 {
     return JNI_TRUE;
@@ -1759,6 +2054,14 @@ int JType_ConvertVarArgPyArgToJObjectArg(JNIEnv* jenv, JPy_ParamDescriptor* para
                 PyErr_Format(PyExc_ValueError, "illegal buffer argument: not a positive item count: %ld", itemCount);
                 return -1;
             }
+            if (itemCount > JPy_MAX_ARRAY_LENGTH) {
+                PyBuffer_Release(pyBuffer);
+                PyMem_Del(pyBuffer);
+                PyErr_Format(PyExc_ValueError,
+                             "illegal buffer argument: %ld items exceed the maximum Java array length of %ld, use jpy.array_chunks() instead",
+                             (long) itemCount, (long) JPy_MAX_ARRAY_LENGTH);
+                return -1;
+            }
 
             if (paramComponentType == JPy_JBoolean) {
                 jArray = (*jenv)->NewBooleanArray(jenv, itemCount);
@@ -2094,6 +2397,14 @@ int JType_ConvertPyArgToJObjectArg(JNIEnv* jenv, JPy_ParamDescriptor* paramDescr
                 PyErr_Format(PyExc_ValueError, "illegal buffer argument: not a positive item count: %ld", itemCount);
                 return -1;
             }
+            if (itemCount > JPy_MAX_ARRAY_LENGTH) {
+                PyBuffer_Release(pyBuffer);
+                PyMem_Del(pyBuffer);
+                PyErr_Format(PyExc_ValueError,
+                             "illegal buffer argument: %ld items exceed the maximum Java array length of %ld, use jpy.array_chunks() instead",
+                             (long) itemCount, (long) JPy_MAX_ARRAY_LENGTH);
+                return -1;
+            }
 
             if (paramComponentType == JPy_JBoolean) {
                 jArray = (*jenv)->NewBooleanArray(jenv, itemCount);
@@ -2203,11 +2514,60 @@ void JType_DisposeReadOnlyBufferArg(JNIEnv* jenv, jvalue* value, void* data)
     }
 }
 
+/**
+ * Mutable buffer arguments are copied back from the Java array in chunks of this size (in bytes).
+ * Chunks which Java did not change are skipped, so that arrays which are only read or sparsely written
+ * by Java don't pay for a second full copy. Define as 0 to always copy back the whole array.
+ */
+#ifndef JPy_COPY_BACK_CHUNK_SIZE
+#define JPy_COPY_BACK_CHUNK_SIZE 4096
+#endif
+
+/**
+ * Copies 'len' bytes from 'src' to 'dst', but only writes those chunks that actually differ.
+ * Adjacent changed chunks are written with a single memcpy().
+ * Returns the number of bytes written.
+ */
+Py_ssize_t JType_CopyBackChangedChunks(char* dst, const char* src, Py_ssize_t len)
+{
+    Py_ssize_t offset;
+    Py_ssize_t chunkSize;
+    Py_ssize_t copyStart;
+    Py_ssize_t copyCount;
+
+    if (JPy_COPY_BACK_CHUNK_SIZE <= 0 || len <= JPy_COPY_BACK_CHUNK_SIZE) {
+        memcpy(dst, src, len);
+        return len;
+    }
+
+    copyStart = -1;
+    copyCount = 0;
+    for (offset = 0; offset < len; offset += chunkSize) {
+        chunkSize = len - offset < JPy_COPY_BACK_CHUNK_SIZE ? len - offset : JPy_COPY_BACK_CHUNK_SIZE;
+        if (memcmp(dst + offset, src + offset, chunkSize) != 0) {
+            if (copyStart < 0) {
+                copyStart = offset;
+            }
+        } else if (copyStart >= 0) {
+            memcpy(dst + copyStart, src + copyStart, offset - copyStart);
+            copyCount += offset - copyStart;
+            copyStart = -1;
+        }
+    }
+    if (copyStart >= 0) {
+        memcpy(dst + copyStart, src + copyStart, len - copyStart);
+        copyCount += len - copyStart;
+    }
+
+    return copyCount;
+}
+
 void JType_DisposeWritableBufferArg(JNIEnv* jenv, jvalue* value, void* data)
 {
     Py_buffer* pyBuffer;
     jarray jArray;
     void* arrayItems;
+    Py_ssize_t copyCount;
 
     pyBuffer = (Py_buffer*) data;
     jArray = (jarray) value->l;
@@ -2218,9 +2578,10 @@ void JType_DisposeWritableBufferArg(JNIEnv* jenv, jvalue* value, void* data)
         // Copy modified array content back into buffer view
         arrayItems = (*jenv)->GetPrimitiveArrayCritical(jenv, jArray, NULL);
         if (arrayItems != NULL) {
-            JPy_DIAG_PRINT(JPy_DIAG_F_EXEC|JPy_DIAG_F_MEM, "JType_DisposeWritableBufferArg: moving Java array into Python buffer: pyBuffer->buf=%p, pyBuffer->len=%d\n", pyBuffer->buf, pyBuffer->len);
-            memcpy(pyBuffer->buf, arrayItems, pyBuffer->len);
-            (*jenv)->ReleasePrimitiveArrayCritical(jenv, jArray, arrayItems, 0);
+            copyCount = JType_CopyBackChangedChunks((char*) pyBuffer->buf, (const char*) arrayItems, pyBuffer->len);
+            // Nothing was written into the Java array, so there is nothing to copy back into it (JNI_ABORT)
+            (*jenv)->ReleasePrimitiveArrayCritical(jenv, jArray, arrayItems, JNI_ABORT);
+            JPy_DIAG_PRINT(JPy_DIAG_F_EXEC|JPy_DIAG_F_MEM, "JType_DisposeWritableBufferArg: moved Java array into Python buffer: pyBuffer->buf=%p, pyBuffer->len=%d, copyCount=%d\n", pyBuffer->buf, pyBuffer->len, copyCount);
         }
         (*jenv)->DeleteLocalRef(jenv, jArray);
         PyBuffer_Release(pyBuffer);
@@ -2359,6 +2720,11 @@ void JType_dealloc(JPy_JType* self)
     Py_XDECREF(self->componentType);
     self->componentType = NULL;
 
+    if (self->resolveLock != NULL) {
+        PyThread_free_lock(self->resolveLock);
+        self->resolveLock = NULL;
+    }
+
     Py_TYPE(self)->tp_free((PyObject*) self);
 }
 
@@ -2369,7 +2735,7 @@ PyObject* JType_getattro(JPy_JType* self, PyObject* name)
 {
     //printf("JType_getattro: %s.%s\n", Py_TYPE(self)->tp_name, JPy_AS_UTF8(name));
 
-    if (!self->isResolved && !self->isResolving) {
+    if (!self->isResolved) {
         JNIEnv* jenv;
         JPy_GET_JNI_ENV_OR_RETURN(jenv, NULL);
         JType_ResolveType(jenv, self);
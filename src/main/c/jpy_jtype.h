@@ -48,10 +48,13 @@ typedef struct JPy_JType
     char isPrimitive;
     // If TRUE, 'classRef' refers to a Java interface type.
     char isInterface;
-    // If TRUE, the type is currently being resolved.
-    char isResolving;
+    // The ident of the thread currently resolving this type, 0 if the type is not being resolved.
+    volatile unsigned long resolvingThread;
+    // Held by the resolving thread, other threads wait on it until the resolution is complete.
+    PyThread_type_lock resolveLock;
     // If TRUE, all the class constructors and methods have already been resolved.
-    char isResolved;
+    // Only set once the type's __dict__ is complete, so it may be tested without holding resolveLock.
+    volatile char isResolved;
 }
 JPy_JType;
 
@@ -129,10 +132,20 @@ PyObject* JType_GetOverloadedMethod(JNIEnv* jenv, JPy_JType* type, PyObject* met
 
 int JType_MatchPyArgAsJObject(JNIEnv* jenv, JPy_JType* type, PyObject* pyArg);
 
+/**
+ * The maximum number of items a Java array can have (Java array lengths are of type 'int').
+ * Python buffers and sequences larger than this can only be passed as chunks, see jpy.array_chunks().
+ */
+#define JPy_MAX_ARRAY_LENGTH 0x7fffffff
+
 int JType_CreateJavaArray(JNIEnv* jenv, JPy_JType* componentType, PyObject* pyArg, jobject* objectRef, jboolean allowObjectWrapping);
+jarray JType_NewPrimitiveArray(JNIEnv* jenv, JPy_JType* componentType, jsize length);
+void JType_SetPrimitiveArrayRegion(JNIEnv* jenv, JPy_JType* componentType, jarray arrayRef, jsize start, jsize length, const void* items);
+void JType_GetPrimitiveArrayRegion(JNIEnv* jenv, JPy_JType* componentType, jarray arrayRef, jsize start, jsize length, void* items);
+size_t JType_GetPrimitiveItemSize(JPy_JType* componentType);
 
 // Non-API. Defined in jpy_jobj.c
-int JType_InitSlots(JPy_JType* type);
+int JType_InitSlots(JNIEnv* jenv, JPy_JType* type);
 // Non-API. Defined in jpy_jtype.c
 int JType_ResolveType(JNIEnv* jenv, JPy_JType* type);
 
@@ -25,6 +25,8 @@
 #include "jpy_jfield.h"
 #include "jpy_jobj.h"
 #include "jpy_conv.h"
+#include "jpy_async.h"
+#include "jpy_watchdog.h"
 #include "jpy_compat.h"
 
 
@@ -38,6 +40,10 @@ PyObject* JPy_destroy_jvm(PyObject* self, PyObject* args);
 PyObject* JPy_get_type(PyObject* self, PyObject* args, PyObject* kwds);
 PyObject* JPy_cast(PyObject* self, PyObject* args);
 PyObject* JPy_array(PyObject* self, PyObject* args);
+PyObject* JPy_array_chunks(PyObject* self, PyObject* args);
+PyObject* JPy_copy_array_chunks(PyObject* self, PyObject* args);
+PyObject* JPy_set_daemon_attach(PyObject* self, PyObject* args);
+PyObject* JPy_thread_stats(PyObject* self);
 
 
 static PyMethodDef JPy_Functions[] = {
@@ -63,10 +69,37 @@ static PyMethodDef JPy_Functions[] = {
                     "array(name, init) - Return a new Java array of given Java type (type name or type object) and initializer (array length or sequence). "
                     "Possible primitive types are 'boolean', 'byte', 'char', 'short', 'int', 'long', 'float', and 'double'."},
 
+    {"array_chunks", JPy_array_chunks, METH_VARARGS,
+                    "array_chunks(name, buffer, chunk_length=2147483647) - Return a new Java array of primitive arrays (e.g. 'double[][]') "
+                    "holding the contents of the given contiguous Python buffer, split into chunks of at most chunk_length items. "
+                    "Use this to pass buffers larger than the maximum Java array length to Java."},
+
+    {"copy_array_chunks", JPy_copy_array_chunks, METH_VARARGS,
+                    "copy_array_chunks(chunks, buffer) - Copy the items of a Java array of primitive arrays (e.g. 'double[][]') "
+                    "into the given writable contiguous Python buffer, which must have exactly the total size of all chunks. "
+                    "Returns the number of items copied."},
+
+    {"set_daemon_attach", JPy_set_daemon_attach, METH_VARARGS,
+                    "set_daemon_attach(daemon) - Set whether Python threads accessing Java are attached to the JVM as daemon threads, "
+                    "which is the default. Threads are detached again when they terminate. Returns the previous setting."},
+
+    {"thread_stats", (PyCFunction) JPy_thread_stats, METH_NOARGS,
+                    "thread_stats() - Return a dictionary with the numbers of threads 'attached' to and 'detached' from the JVM by jpy, "
+                    "and the number of threads still 'active'."},
+
+    {"call_nogil",  (PyCFunction) JPy_call_nogil, METH_VARARGS|METH_KEYWORDS,
+                    "call_nogil(callable, *args, **kwargs) - Call the given callable, invoking all Java methods it calls with the GIL released, "
+                    "so that other Python threads run meanwhile. Python objects passed to these Java methods must not be modified by other threads."},
+
+    {"call_async",  (PyCFunction) JPy_call_async, METH_VARARGS|METH_KEYWORDS,
+                    "call_async(callable, *args, **kwargs) - Return an asyncio future for call_nogil(callable, *args, **kwargs), run in "
+                    "the default executor of the running event loop. Use it to call slow Java methods from coroutines without blocking the loop."},
+
     {NULL, NULL, 0, NULL} /*Sentinel*/
 };
 
 void JPy_free(void* unused);
+PyObject* JException_NewType(void);
 
 #define JPY_MODULE_NAME "jpy"
 #define JPY_MODULE_DOC  "Bi-directional Python-Java Bridge"
@@ -98,6 +131,29 @@ JavaVM* JPy_JVM = NULL;
 // If true, this JVM structure has been initialised from Python jpy.create_jvm()
 jboolean JPy_MustDestroyJVM = JNI_FALSE;
 
+#if defined(JPY_FREE_THREADED)
+// The lock behind JPy_BEGIN_GLOBALS_LOCK, made recursive by tracking its owner: JPy_GlobalsLockOwner
+// only ever holds the ident of the thread that currently owns the mutex.
+static PyMutex JPy_GlobalsMutex = {0};
+static volatile unsigned long JPy_GlobalsLockOwner = 0;
+static int JPy_GlobalsLockDepth = 0;
+#endif
+
+// If true, Python threads are attached to the JVM as daemon threads, see jpy.set_daemon_attach()
+int JPy_AttachAsDaemon = 1;
+// The numbers of Python threads attached to and detached from the JVM by JPy_GetJNIEnv(), see jpy.thread_stats()
+long JPy_AttachedThreadCount = 0;
+long JPy_DetachedThreadCount = 0;
+
+// The JNI environment of the current thread, valid as long as JPy_ThreadJVM == JPy_JVM.
+// Only cached for threads attached by JPy_GetJNIEnv(), which are detached by JPy_DetachThread() only.
+static JPy_THREAD_LOCAL JNIEnv* JPy_ThreadJNIEnv = NULL;
+static JPy_THREAD_LOCAL JavaVM* JPy_ThreadJVM = NULL;
+// Set once the current thread has been detached while its Python thread state is cleared
+static JPy_THREAD_LOCAL int JPy_ThreadDetached = 0;
+
+#define JPy_THREAD_ATTACHMENT_KEY "jpy.thread_attachment"
+
 
 // Global VM Information (maybe better place this in the JPy_JVM structure later)
 // {{{
@@ -174,6 +230,7 @@ jclass JPy_Map_Entry_JClass = NULL;
 jmethodID JPy_Map_entrySet_MID = NULL;
 jmethodID JPy_Map_put_MID = NULL;
 jmethodID JPy_Map_clear_MID = NULL;
+jmethodID JPy_Map_remove_MID = NULL;
 jmethodID JPy_Map_Entry_getKey_MID = NULL;
 jmethodID JPy_Map_Entry_getValue_MID = NULL;
 // java.util.Set
@@ -184,12 +241,25 @@ jclass JPy_Iterator_JClass = NULL;
 jmethodID JPy_Iterator_next_MID = NULL;
 jmethodID JPy_Iterator_hasNext_MID = NULL;
 
+// java.nio.Buffer
+jclass JPy_Buffer_JClass = NULL;
+jmethodID JPy_Buffer_IsReadOnly_MID = NULL;
+
+// java.util.concurrent
+jclass JPy_CompletionStage_JClass = NULL;
+jclass JPy_Future_JClass = NULL;
+
 jclass JPy_RuntimeException_JClass = NULL;
 jclass JPy_OutOfMemoryError_JClass = NULL;
 jclass JPy_UnsupportedOperationException_JClass = NULL;
 jclass JPy_FileNotFoundException_JClass = NULL;
+jclass JPy_PyException_JClass = NULL;
 jclass JPy_KeyError_JClass = NULL;
 jclass JPy_StopIteration_JClass = NULL;
+// The PyException(long value, long traceback) constructors
+jmethodID JPy_PyException_Init_MID = NULL;
+jmethodID JPy_KeyError_Init_MID = NULL;
+jmethodID JPy_StopIteration_Init_MID = NULL;
 
 // java.lang.Boolean
 jclass JPy_Boolean_JClass = NULL;
@@ -235,6 +305,14 @@ jmethodID JPy_PyModule_Init_MID = NULL;
 
 jmethodID JPy_PyDictWrapper_GetPointer_MID = NULL;
 
+// org.jpy.annotations.ParamAnnotations (optional, NULL if jpy.jar is not on the classpath)
+jclass JPy_ParamAnnotations_JClass = NULL;
+jmethodID JPy_ParamAnnotations_GetFlags_MID = NULL;
+
+// org.jpy.PyFutures (optional, NULL if jpy.jar is not on the classpath)
+jclass JPy_PyFutures_JClass = NULL;
+jmethodID JPy_PyFutures_WhenComplete_SMID = NULL;
+
 // java.lang.Throwable
 jclass JPy_Throwable_JClass = NULL;
 jmethodID JPy_Throwable_getStackTrace_MID = NULL;
@@ -246,6 +324,107 @@ jclass JPy_StackTraceElement_JClass = NULL;
 // }}}
 
 
+#if defined(JPY_FREE_THREADED)
+
+void JPy_LockGlobals(void)
+{
+    unsigned long thread = PyThread_get_thread_ident();
+    if (JPy_GlobalsLockOwner == thread) {
+        JPy_GlobalsLockDepth++;
+        return;
+    }
+    PyMutex_Lock(&JPy_GlobalsMutex);
+    JPy_GlobalsLockOwner = thread;
+    JPy_GlobalsLockDepth = 1;
+}
+
+void JPy_UnlockGlobals(void)
+{
+    if (--JPy_GlobalsLockDepth == 0) {
+        JPy_GlobalsLockOwner = 0;
+        PyMutex_Unlock(&JPy_GlobalsMutex);
+    }
+}
+
+#endif
+
+PyObject* JPy_GetDictItemStringRef(PyObject* dict, const char* key)
+{
+#if defined(JPY_FREE_THREADED)
+    PyObject* value;
+    if (PyDict_GetItemStringRef(dict, key, &value) < 0) {
+        PyErr_Clear();
+        return NULL;
+    }
+    return value;
+#else
+    PyObject* value = PyDict_GetItemString(dict, key);
+    Py_XINCREF(value);
+    return value;
+#endif
+}
+
+/**
+ * The destructor of the capsule stored in the thread state dictionary of a thread attached by JPy_GetJNIEnv().
+ * Python clears the thread state of a terminating thread in that thread, so it is detached from the JVM here.
+ */
+void JPy_DetachThread(PyObject* capsule)
+{
+    JNIEnv* jenv;
+    JavaVM* jvm;
+
+    jenv = (JNIEnv*) PyCapsule_GetPointer(capsule, JPy_THREAD_ATTACHMENT_KEY);
+    jvm = JPy_JVM;
+    // Thread states of other threads are cleared when the interpreter is finalized, don't detach them
+    if (jenv == NULL || jenv != JPy_ThreadJNIEnv || jvm == NULL || jvm != JPy_ThreadJVM) {
+        PyErr_Clear();
+        return;
+    }
+
+    JPy_ThreadJNIEnv = NULL;
+    JPy_ThreadJVM = NULL;
+    JPy_ThreadDetached = 1;
+    JWatchdog_ReleaseThread();
+    if ((*jvm)->DetachCurrentThread(jvm) == JNI_OK) {
+        JPy_BEGIN_GLOBALS_LOCK
+        JPy_DetachedThreadCount++;
+        JPy_END_GLOBALS_LOCK
+        JPy_DIAG_PRINT(JPy_DIAG_F_JVM, "JPy_DetachThread: Detached current thread from JVM: jenv=%p\n", jenv);
+    }
+}
+
+/**
+ * Makes sure the current thread, just attached to the JVM, is detached again once its Python thread state is cleared.
+ * Returns 0 on success, or -1 if the thread will not be detached by jpy.
+ */
+int JPy_RegisterThreadAttachment(JNIEnv* jenv)
+{
+    PyObject* pyThreadDict;
+    PyObject* pyCapsule;
+    int result;
+
+    // The JVM will be left attached to a thread which accesses Java while its thread state is being cleared
+    if (JPy_ThreadDetached) {
+        return -1;
+    }
+
+    pyThreadDict = PyThreadState_GetDict();
+    if (pyThreadDict == NULL) {
+        return -1;
+    }
+    pyCapsule = PyCapsule_New(jenv, JPy_THREAD_ATTACHMENT_KEY, JPy_DetachThread);
+    if (pyCapsule == NULL) {
+        PyErr_Clear();
+        return -1;
+    }
+    result = PyDict_SetItemString(pyThreadDict, JPy_THREAD_ATTACHMENT_KEY, pyCapsule);
+    if (result < 0) {
+        PyErr_Clear();
+    }
+    Py_DECREF(pyCapsule);
+    return result;
+}
+
 JNIEnv* JPy_GetJNIEnv(void)
 {
     JavaVM* jvm;
@@ -258,10 +437,29 @@ JNIEnv* JPy_GetJNIEnv(void)
         return NULL;
     }
 
+    // Fast path: the current thread has been attached by us and its JNI environment is already known
+    if (JPy_ThreadJVM == jvm) {
+        return JPy_ThreadJNIEnv;
+    }
+
     status = (*jvm)->GetEnv(jvm, (void**) &jenv, JPY_JNI_VERSION);
     if (status == JNI_EDETACHED) {
-        if ((*jvm)->AttachCurrentThread(jvm, (void**) &jenv, NULL) == 0) {
-            JPy_DIAG_PRINT(JPy_DIAG_F_JVM, "JPy_GetJNIEnv: Attached current thread to JVM: jenv=%p\n", jenv);
+        if (JPy_AttachAsDaemon) {
+            status = (*jvm)->AttachCurrentThreadAsDaemon(jvm, (void**) &jenv, NULL);
+        } else {
+            status = (*jvm)->AttachCurrentThread(jvm, (void**) &jenv, NULL);
+        }
+        if (status == JNI_OK) {
+            JPy_BEGIN_GLOBALS_LOCK
+            JPy_AttachedThreadCount++;
+            JPy_END_GLOBALS_LOCK
+            JPy_DIAG_PRINT(JPy_DIAG_F_JVM, "JPy_GetJNIEnv: Attached current thread to JVM: jenv=%p, daemon=%d\n", jenv, JPy_AttachAsDaemon);
+            // Other threads may be detached and reattached by their owner, e.g. the JVM, at any time,
+            // which would leave a cached JNI environment stale
+            if (JPy_RegisterThreadAttachment(jenv) == 0) {
+                JPy_ThreadJNIEnv = jenv;
+                JPy_ThreadJVM = jvm;
+            }
         } else {
             PyErr_SetString(PyExc_RuntimeError, "jpy: Failed to attach current thread to JVM.");
             return NULL;
@@ -274,6 +472,7 @@ JNIEnv* JPy_GetJNIEnv(void)
         JPy_DIAG_PRINT(JPy_DIAG_F_JVM, "JPy_GetJNIEnv: jenv=%p\n", jenv);
     } else {
         JPy_DIAG_PRINT(JPy_DIAG_F_JVM + JPy_DIAG_F_ERR, "JPy_GetJNIEnv: Received unhandled status code from JVM GetEnv(): status=%d\n", status);
+        return jenv;
     }
 
     return jenv;
@@ -303,6 +502,10 @@ PyMODINIT_FUNC JPY_MODULE_INIT_FUNC(void)
     if (JPy_Module == NULL) {
         JPY_RETURN(NULL);
     }
+#if defined(JPY_FREE_THREADED)
+    // jpy guards its global state itself, see JPy_BEGIN_GLOBALS_LOCK, so importing it must not enable the GIL
+    PyUnstable_Module_SetGIL(JPy_Module, Py_MOD_GIL_NOT_USED);
+#endif
 #elif defined(JPY_COMPAT_27)
     JPy_Module = Py_InitModule3(JPY_MODULE_NAME, JPy_Functions, JPY_MODULE_DOC);
     if (JPy_Module == NULL) {
@@ -346,7 +549,10 @@ PyMODINIT_FUNC JPY_MODULE_INIT_FUNC(void)
 
     /////////////////////////////////////////////////////////////////////////
 
-    JException_Type = PyErr_NewException("jpy.JException", NULL, NULL);
+    JException_Type = JException_NewType();
+    if (JException_Type == NULL) {
+        JPY_RETURN(NULL);
+    }
     Py_INCREF(JException_Type);
     PyModule_AddObject(JPy_Module, "JException", JException_Type);
 
@@ -510,11 +716,35 @@ PyObject* JPy_destroy_jvm(PyObject* self, PyObject* args)
         JPy_ClearGlobalVars(JPy_GetJNIEnv());
         (*JPy_JVM)->DestroyJavaVM(JPy_JVM);
         JPy_JVM = NULL;
+        JPy_ThreadJNIEnv = NULL;
+        JPy_ThreadJVM = NULL;
     }
 
     return Py_BuildValue("");
 }
 
+PyObject* JPy_set_daemon_attach(PyObject* self, PyObject* args)
+{
+    int daemon;
+    int oldDaemon;
+
+    if (!PyArg_ParseTuple(args, "i:set_daemon_attach", &daemon)) {
+        return NULL;
+    }
+
+    oldDaemon = JPy_AttachAsDaemon;
+    JPy_AttachAsDaemon = daemon != 0;
+    return PyBool_FromLong(oldDaemon);
+}
+
+PyObject* JPy_thread_stats(PyObject* self)
+{
+    return Py_BuildValue("{s:l,s:l,s:l}",
+                         "attached", JPy_AttachedThreadCount,
+                         "detached", JPy_DetachedThreadCount,
+                         "active", JPy_AttachedThreadCount - JPy_DetachedThreadCount);
+}
+
 PyObject* JPy_get_type(PyObject* self, PyObject* args, PyObject* kwds)
 {
     JNIEnv* jenv;
@@ -610,11 +840,20 @@ PyObject* JPy_array(PyObject* self, PyObject* args)
     }
 
     if (JPy_IS_CLONG(objInit)) {
-        jint length = JPy_AS_CLONG(objInit);
-        if (length < 0) {
+        PY_LONG_LONG initLength = JPy_AS_CLONGLONG(objInit);
+        jint length;
+        if (initLength == -1 && PyErr_Occurred()) {
+            return NULL;
+        }
+        if (initLength < 0) {
             PyErr_SetString(PyExc_ValueError, "array: argument 2 (init) must be either an integer array length or any sequence");
             return NULL;
         }
+        if (initLength > JPy_MAX_ARRAY_LENGTH) {
+            PyErr_Format(PyExc_ValueError, "array: argument 2 (init) exceeds the maximum Java array length of %ld, use jpy.array_chunks() instead", (long) JPy_MAX_ARRAY_LENGTH);
+            return NULL;
+        }
+        length = (jint) initLength;
         if (componentType == JPy_JBoolean) {
             arrayRef = (*jenv)->NewBooleanArray(jenv, length);
         } else if (componentType == JPy_JChar) {
@@ -650,6 +889,226 @@ PyObject* JPy_array(PyObject* self, PyObject* args)
 }
 
 
+/**
+ * Gets the primitive component type given by a type name or type object argument.
+ */
+JPy_JType* JPy_GetPrimitiveTypeArg(JNIEnv* jenv, PyObject* objType, const char* funcName)
+{
+    JPy_JType* type;
+
+    if (JPy_IS_STR(objType)) {
+        type = JType_GetTypeForName(jenv, JPy_AS_UTF8(objType), JNI_FALSE);
+        if (type == NULL) {
+            return NULL;
+        }
+    } else if (JType_Check(objType)) {
+        type = (JPy_JType*) objType;
+    } else {
+        PyErr_Format(PyExc_ValueError, "%s: argument 1 (type) must be a type name or Java type object", funcName);
+        return NULL;
+    }
+
+    if (!type->isPrimitive || type == JPy_JVoid) {
+        PyErr_Format(PyExc_ValueError, "%s: argument 1 (type) must be a primitive Java type other than 'void'", funcName);
+        return NULL;
+    }
+
+    return type;
+}
+
+PyObject* JPy_array_chunks(PyObject* self, PyObject* args)
+{
+    JNIEnv* jenv;
+    JPy_JType* componentType;
+    PyObject* objType;
+    PyObject* objBuffer;
+    PyObject* result;
+    Py_ssize_t chunkLength;
+    Py_ssize_t itemCount;
+    Py_ssize_t chunkCount;
+    Py_ssize_t chunkIndex;
+    Py_ssize_t offset;
+    jsize length;
+    size_t itemSize;
+    Py_buffer pyBuffer;
+    jarray chunkRef;
+    jclass chunkClassRef;
+    jobjectArray chunksRef;
+
+    JPy_GET_JNI_ENV_OR_RETURN(jenv, NULL)
+
+    chunkLength = JPy_MAX_ARRAY_LENGTH;
+    if (!PyArg_ParseTuple(args, "OO|n:array_chunks", &objType, &objBuffer, &chunkLength)) {
+        return NULL;
+    }
+
+    componentType = JPy_GetPrimitiveTypeArg(jenv, objType, "array_chunks");
+    if (componentType == NULL) {
+        return NULL;
+    }
+
+    if (chunkLength <= 0 || chunkLength > JPy_MAX_ARRAY_LENGTH) {
+        PyErr_Format(PyExc_ValueError, "array_chunks: argument 3 (chunk_length) must be in the range 1 to %ld", (long) JPy_MAX_ARRAY_LENGTH);
+        return NULL;
+    }
+
+    if (PyObject_GetBuffer(objBuffer, &pyBuffer, PyBUF_SIMPLE) < 0) {
+        return NULL;
+    }
+
+    itemSize = JType_GetPrimitiveItemSize(componentType);
+    if (pyBuffer.len % itemSize != 0) {
+        PyErr_Format(PyExc_ValueError, "array_chunks: buffer size of %ld bytes is not a multiple of the item size of Java type '%s' (%d bytes)",
+                     (long) pyBuffer.len, componentType->javaName, (int) itemSize);
+        PyBuffer_Release(&pyBuffer);
+        return NULL;
+    }
+
+    itemCount = pyBuffer.len / itemSize;
+    chunkCount = (itemCount + chunkLength - 1) / chunkLength;
+    if (chunkCount > JPy_MAX_ARRAY_LENGTH) {
+        PyErr_SetString(PyExc_ValueError, "array_chunks: too many chunks, use a larger chunk_length");
+        PyBuffer_Release(&pyBuffer);
+        return NULL;
+    }
+
+    JPy_DIAG_PRINT(JPy_DIAG_F_MEM, "JPy_array_chunks: type='%s', itemCount=%ld, chunkLength=%ld, chunkCount=%ld\n",
+                   componentType->javaName, (long) itemCount, (long) chunkLength, (long) chunkCount);
+
+    // We need the class of the chunks (e.g. double[]) for creating the outer array
+    chunkRef = JType_NewPrimitiveArray(jenv, componentType, 0);
+    if (chunkRef == NULL) {
+        PyBuffer_Release(&pyBuffer);
+        JPy_HandleJavaException(jenv);
+        return NULL;
+    }
+    chunkClassRef = (*jenv)->GetObjectClass(jenv, chunkRef);
+    (*jenv)->DeleteLocalRef(jenv, chunkRef);
+
+    chunksRef = (*jenv)->NewObjectArray(jenv, (jsize) chunkCount, chunkClassRef, NULL);
+    (*jenv)->DeleteLocalRef(jenv, chunkClassRef);
+    if (chunksRef == NULL) {
+        PyBuffer_Release(&pyBuffer);
+        JPy_HandleJavaException(jenv);
+        return NULL;
+    }
+
+    // Copy chunk by chunk, so that at no time a second full copy of the data exists besides the Java heap
+    offset = 0;
+    for (chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++) {
+        length = (jsize) (itemCount - offset < chunkLength ? itemCount - offset : chunkLength);
+        chunkRef = JType_NewPrimitiveArray(jenv, componentType, length);
+        if (chunkRef == NULL || (*jenv)->ExceptionCheck(jenv)) {
+            (*jenv)->DeleteLocalRef(jenv, chunksRef);
+            PyBuffer_Release(&pyBuffer);
+            JPy_HandleJavaException(jenv);
+            return NULL;
+        }
+        JType_SetPrimitiveArrayRegion(jenv, componentType, chunkRef, 0, length, (const char*) pyBuffer.buf + offset * itemSize);
+        (*jenv)->SetObjectArrayElement(jenv, chunksRef, (jsize) chunkIndex, chunkRef);
+        (*jenv)->DeleteLocalRef(jenv, chunkRef);
+        offset += length;
+    }
+
+    PyBuffer_Release(&pyBuffer);
+
+    result = JObj_New(jenv, chunksRef);
+    (*jenv)->DeleteLocalRef(jenv, chunksRef);
+    return result;
+}
+
+PyObject* JPy_copy_array_chunks(PyObject* self, PyObject* args)
+{
+    JNIEnv* jenv;
+    JPy_JType* chunksType;
+    JPy_JType* componentType;
+    PyObject* objChunks;
+    PyObject* objBuffer;
+    jobjectArray chunksRef;
+    jarray chunkRef;
+    jsize chunkCount;
+    jsize chunkIndex;
+    jsize length;
+    Py_ssize_t itemCount;
+    Py_ssize_t offset;
+    size_t itemSize;
+    Py_buffer pyBuffer;
+
+    JPy_GET_JNI_ENV_OR_RETURN(jenv, NULL)
+
+    if (!PyArg_ParseTuple(args, "OO:copy_array_chunks", &objChunks, &objBuffer)) {
+        return NULL;
+    }
+
+    chunksType = JObj_Check(objChunks) ? (JPy_JType*) Py_TYPE(objChunks) : NULL;
+    if (chunksType == NULL
+        || chunksType->componentType == NULL
+        || chunksType->componentType->componentType == NULL
+        || !chunksType->componentType->componentType->isPrimitive) {
+        PyErr_SetString(PyExc_ValueError, "copy_array_chunks: argument 1 (chunks) must be a Java array of primitive arrays");
+        return NULL;
+    }
+
+    componentType = chunksType->componentType->componentType;
+    itemSize = JType_GetPrimitiveItemSize(componentType);
+    chunksRef = ((JPy_JObj*) objChunks)->objectRef;
+    chunkCount = (*jenv)->GetArrayLength(jenv, chunksRef);
+
+    // First pass: validate the total size before anything is written into the buffer
+    itemCount = 0;
+    for (chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++) {
+        chunkRef = (*jenv)->GetObjectArrayElement(jenv, chunksRef, chunkIndex);
+        if (chunkRef != NULL) {
+            itemCount += (*jenv)->GetArrayLength(jenv, chunkRef);
+            (*jenv)->DeleteLocalRef(jenv, chunkRef);
+        }
+    }
+
+    if (PyObject_GetBuffer(objBuffer, &pyBuffer, PyBUF_WRITABLE) < 0) {
+        return NULL;
+    }
+
+    if (pyBuffer.len != (Py_ssize_t) (itemCount * itemSize)) {
+        PyErr_Format(PyExc_ValueError, "copy_array_chunks: expected a buffer of %ld bytes, but got %ld bytes",
+                     (long) (itemCount * itemSize), (long) pyBuffer.len);
+        PyBuffer_Release(&pyBuffer);
+        return NULL;
+    }
+
+    // Second pass: Java threads may have replaced chunks meanwhile, so never write beyond the validated size
+    offset = 0;
+    for (chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++) {
+        chunkRef = (*jenv)->GetObjectArrayElement(jenv, chunksRef, chunkIndex);
+        if (chunkRef != NULL) {
+            length = (*jenv)->GetArrayLength(jenv, chunkRef);
+            if (offset + length > itemCount) {
+                (*jenv)->DeleteLocalRef(jenv, chunkRef);
+                PyBuffer_Release(&pyBuffer);
+                PyErr_SetString(PyExc_ValueError, "copy_array_chunks: chunks have been modified while copying");
+                return NULL;
+            }
+            JType_GetPrimitiveArrayRegion(jenv, componentType, chunkRef, 0, length, (char*) pyBuffer.buf + offset * itemSize);
+            (*jenv)->DeleteLocalRef(jenv, chunkRef);
+            if ((*jenv)->ExceptionCheck(jenv)) {
+                PyBuffer_Release(&pyBuffer);
+                JPy_HandleJavaException(jenv);
+                return NULL;
+            }
+            offset += length;
+        }
+    }
+
+    PyBuffer_Release(&pyBuffer);
+
+    if (offset != itemCount) {
+        PyErr_SetString(PyExc_ValueError, "copy_array_chunks: chunks have been modified while copying");
+        return NULL;
+    }
+
+    return PyLong_FromSsize_t(itemCount);
+}
+
+
 JPy_JType* JPy_GetNonObjectJType(JNIEnv* jenv, jclass classRef)
 {
     jclass primClassRef;
@@ -748,6 +1207,7 @@ jmethodID JPy_GetMethod(JNIEnv* jenv, jclass classRef, const char* name, const c
 int initGlobalPyObjectVars(JNIEnv* jenv)
 {
     JPy_JType *dictType;
+    JPy_JType *pyExceptionType;
     JPy_JType *keyErrorType;
     JPy_JType *stopIterationType;
 
@@ -778,12 +1238,22 @@ int initGlobalPyObjectVars(JNIEnv* jenv)
         DEFINE_METHOD(JPy_PyDictWrapper_GetPointer_MID, JPy_PyDictWrapper_JClass, "getPointer", "()J");
     }
 
+    pyExceptionType = JType_GetTypeForName(jenv, "org.jpy.PyException", JNI_FALSE);
+    if (pyExceptionType == NULL) {
+        PyErr_Clear();
+        return -1;
+    } else {
+        JPy_PyException_JClass = pyExceptionType->classRef;
+        DEFINE_METHOD(JPy_PyException_Init_MID, JPy_PyException_JClass, "<init>", "(JJ)V");
+    }
+
     keyErrorType = JType_GetTypeForName(jenv, "org.jpy.KeyError", JNI_FALSE);
     if (keyErrorType == NULL) {
         PyErr_Clear();
         return -1;
     } else {
         JPy_KeyError_JClass = keyErrorType->classRef;
+        DEFINE_METHOD(JPy_KeyError_Init_MID, JPy_KeyError_JClass, "<init>", "(JJ)V");
     }
 
     stopIterationType = JType_GetTypeForName(jenv, "org.jpy.StopIteration", JNI_FALSE);
@@ -792,6 +1262,64 @@ int initGlobalPyObjectVars(JNIEnv* jenv)
         return -1;
     } else {
         JPy_StopIteration_JClass = stopIterationType->classRef;
+        DEFINE_METHOD(JPy_StopIteration_Init_MID, JPy_StopIteration_JClass, "<init>", "(JJ)V");
+    }
+
+    return 0;
+}
+
+
+int initGlobalFutureVars(JNIEnv* jenv)
+{
+    jclass localClassRef;
+
+    localClassRef = (*jenv)->FindClass(jenv, "org/jpy/PyFutures");
+    if (localClassRef == NULL || (*jenv)->ExceptionCheck(jenv)) {
+        // org.jpy.PyFutures may not be on the classpath, which is ok; Java futures are then awaited in an executor
+        (*jenv)->ExceptionClear(jenv);
+        return -1;
+    }
+
+    JPy_PyFutures_WhenComplete_SMID = (*jenv)->GetStaticMethodID(jenv, localClassRef, "whenComplete", "(Ljava/util/concurrent/CompletionStage;J)V");
+    if (JPy_PyFutures_WhenComplete_SMID == NULL) {
+        (*jenv)->ExceptionClear(jenv);
+        (*jenv)->DeleteLocalRef(jenv, localClassRef);
+        return -1;
+    }
+
+    JPy_PyFutures_JClass = (*jenv)->NewGlobalRef(jenv, localClassRef);
+    (*jenv)->DeleteLocalRef(jenv, localClassRef);
+    if (JPy_PyFutures_JClass == NULL) {
+        JPy_PyFutures_WhenComplete_SMID = NULL;
+        return -1;
+    }
+
+    return 0;
+}
+
+int initGlobalAnnotationVars(JNIEnv* jenv)
+{
+    jclass localClassRef;
+
+    localClassRef = (*jenv)->FindClass(jenv, "org/jpy/annotations/ParamAnnotations");
+    if (localClassRef == NULL || (*jenv)->ExceptionCheck(jenv)) {
+        // org.jpy.annotations may not be on the classpath, which is ok; parameter annotations are then ignored
+        (*jenv)->ExceptionClear(jenv);
+        return -1;
+    }
+
+    JPy_ParamAnnotations_GetFlags_MID = (*jenv)->GetStaticMethodID(jenv, localClassRef, "getFlags", "([Ljava/lang/reflect/Executable;)[[I");
+    if (JPy_ParamAnnotations_GetFlags_MID == NULL) {
+        (*jenv)->ExceptionClear(jenv);
+        (*jenv)->DeleteLocalRef(jenv, localClassRef);
+        return -1;
+    }
+
+    JPy_ParamAnnotations_JClass = (*jenv)->NewGlobalRef(jenv, localClassRef);
+    (*jenv)->DeleteLocalRef(jenv, localClassRef);
+    if (JPy_ParamAnnotations_JClass == NULL) {
+        JPy_ParamAnnotations_GetFlags_MID = NULL;
+        return -1;
     }
 
     return 0;
@@ -842,6 +1370,7 @@ int JPy_InitGlobalVars(JNIEnv* jenv)
     DEFINE_METHOD(JPy_Map_entrySet_MID, JPy_Map_JClass, "entrySet", "()Ljava/util/Set;");
     DEFINE_METHOD(JPy_Map_put_MID, JPy_Map_JClass, "put", "(Ljava/lang/Object;Ljava/lang/Object;)Ljava/lang/Object;");
     DEFINE_METHOD(JPy_Map_clear_MID, JPy_Map_JClass, "clear", "()V");
+    DEFINE_METHOD(JPy_Map_remove_MID, JPy_Map_JClass, "remove", "(Ljava/lang/Object;)Ljava/lang/Object;");
 
     DEFINE_CLASS(JPy_Map_Entry_JClass, "java/util/Map$Entry");
     DEFINE_METHOD(JPy_Map_Entry_getKey_MID, JPy_Map_Entry_JClass, "getKey", "()Ljava/lang/Object;");
@@ -856,6 +1385,14 @@ int JPy_InitGlobalVars(JNIEnv* jenv)
     DEFINE_METHOD(JPy_Iterator_next_MID, JPy_Iterator_JClass, "next", "()Ljava/lang/Object;");
     DEFINE_METHOD(JPy_Iterator_hasNext_MID, JPy_Iterator_JClass, "hasNext", "()Z");
 
+    // java.nio.Buffer
+    DEFINE_CLASS(JPy_Buffer_JClass, "java/nio/Buffer");
+    DEFINE_METHOD(JPy_Buffer_IsReadOnly_MID, JPy_Buffer_JClass, "isReadOnly", "()Z");
+
+    // java.util.concurrent, must be defined before any type is created, see JType_InitSlots()
+    DEFINE_CLASS(JPy_CompletionStage_JClass, "java/util/concurrent/CompletionStage");
+    DEFINE_CLASS(JPy_Future_JClass, "java/util/concurrent/Future");
+
     DEFINE_CLASS(JPy_RuntimeException_JClass, "java/lang/RuntimeException");
     DEFINE_CLASS(JPy_OutOfMemoryError_JClass, "java/lang/OutOfMemoryError");
     DEFINE_CLASS(JPy_FileNotFoundException_JClass, "java/io/FileNotFoundException");
@@ -928,6 +1465,14 @@ int JPy_InitGlobalVars(JNIEnv* jenv)
     DEFINE_METHOD(JPy_Throwable_getCause_MID, JPy_Throwable_JClass, "getCause", "()Ljava/lang/Throwable;");
     DEFINE_METHOD(JPy_Throwable_getStackTrace_MID, JPy_Throwable_JClass, "getStackTrace", "()[Ljava/lang/StackTraceElement;");
 
+    if (initGlobalAnnotationVars(jenv) < 0) {
+        JPy_DIAG_PRINT(JPy_DIAG_F_TYPE, "JPy_InitGlobalVars: org.jpy.annotations not found, parameter annotations will be ignored\n");
+    }
+
+    if (initGlobalFutureVars(jenv) < 0) {
+        JPy_DIAG_PRINT(JPy_DIAG_F_TYPE, "JPy_InitGlobalVars: org.jpy.PyFutures not found, Java futures will be awaited in an executor\n");
+    }
+
     // JType_AddClassAttribute is actually called from within JType_GetType(), but not for
     // JPy_JObject and JPy_JClass for an obvious reason. So we do it now:
     JType_AddClassAttribute(jenv, JPy_JObject);
@@ -949,6 +1494,7 @@ void JPy_ClearGlobalVars(JNIEnv* jenv)
         (*jenv)->DeleteGlobalRef(jenv, JPy_Constructor_JClass);
         (*jenv)->DeleteGlobalRef(jenv, JPy_Method_JClass);
         (*jenv)->DeleteGlobalRef(jenv, JPy_Field_JClass);
+        (*jenv)->DeleteGlobalRef(jenv, JPy_Buffer_JClass);
         (*jenv)->DeleteGlobalRef(jenv, JPy_RuntimeException_JClass);
         (*jenv)->DeleteGlobalRef(jenv, JPy_Boolean_JClass);
         (*jenv)->DeleteGlobalRef(jenv, JPy_Character_JClass);
@@ -961,6 +1507,14 @@ void JPy_ClearGlobalVars(JNIEnv* jenv)
         (*jenv)->DeleteGlobalRef(jenv, JPy_Number_JClass);
         (*jenv)->DeleteGlobalRef(jenv, JPy_Void_JClass);
         (*jenv)->DeleteGlobalRef(jenv, JPy_String_JClass);
+        (*jenv)->DeleteGlobalRef(jenv, JPy_CompletionStage_JClass);
+        (*jenv)->DeleteGlobalRef(jenv, JPy_Future_JClass);
+        if (JPy_ParamAnnotations_JClass != NULL) {
+            (*jenv)->DeleteGlobalRef(jenv, JPy_ParamAnnotations_JClass);
+        }
+        if (JPy_PyFutures_JClass != NULL) {
+            (*jenv)->DeleteGlobalRef(jenv, JPy_PyFutures_JClass);
+        }
     }
 
     JPy_Comparable_JClass = NULL;
@@ -969,6 +1523,7 @@ void JPy_ClearGlobalVars(JNIEnv* jenv)
     JPy_Constructor_JClass = NULL;
     JPy_Method_JClass = NULL;
     JPy_Field_JClass = NULL;
+    JPy_Buffer_JClass = NULL;
     JPy_RuntimeException_JClass = NULL;
     JPy_Boolean_JClass = NULL;
     JPy_Character_JClass = NULL;
@@ -981,6 +1536,11 @@ void JPy_ClearGlobalVars(JNIEnv* jenv)
     JPy_Number_JClass = NULL;
     JPy_Void_JClass = NULL;
     JPy_String_JClass = NULL;
+    JPy_CompletionStage_JClass = NULL;
+    JPy_Future_JClass = NULL;
+    JPy_ParamAnnotations_JClass = NULL;
+    JPy_PyFutures_JClass = NULL;
+    JPy_PyFutures_WhenComplete_SMID = NULL;
 
     JPy_Object_ToString_MID = NULL;
     JPy_Object_HashCode_MID = NULL;
@@ -1003,6 +1563,7 @@ void JPy_ClearGlobalVars(JNIEnv* jenv)
     JPy_Field_GetName_MID = NULL;
     JPy_Field_GetModifiers_MID = NULL;
     JPy_Field_GetType_MID = NULL;
+    JPy_Buffer_IsReadOnly_MID = NULL;
     JPy_Boolean_Init_MID = NULL;
     JPy_Boolean_BooleanValue_MID = NULL;
     JPy_Character_Init_MID = NULL;
@@ -1017,6 +1578,7 @@ void JPy_ClearGlobalVars(JNIEnv* jenv)
     JPy_Number_LongValue_MID = NULL;
     JPy_Number_DoubleValue_MID = NULL;
     JPy_PyObject_GetPointer_MID = NULL;
+    JPy_ParamAnnotations_GetFlags_MID = NULL;
 
     Py_XDECREF(JPy_JBoolean);
     Py_XDECREF(JPy_JChar);
@@ -1066,57 +1628,115 @@ void JPy_ClearGlobalVars(JNIEnv* jenv)
 #define CAUSED_BY_STRLEN 10
 #define ELIDED_STRING_MAX_SIZE 30
 
-void JPy_HandleJavaException(JNIEnv* jenv)
-{
-    jthrowable error = (*jenv)->ExceptionOccurred(jenv);
-    if (error != NULL) {
-        jstring message;
-        int allocError = 0;
-
-        if (JPy_DiagFlags != 0) {
-            (*jenv)->ExceptionDescribe(jenv);
-        }
-
-        if (JPy_VerboseExceptions) {
-            char *stackTraceString;
-            size_t stackTraceLength = 0;
-            jthrowable cause = error;
-            jarray enclosingElements = NULL;
-            jint enclosingSize = 0;
-
-            stackTraceString = strdup("");
+#define JPy_JEXCEPTION_ATTR_JAVA_EXCEPTION "java_exception"
+#define JPy_JEXCEPTION_ATTR_VERBOSE "_verbose"
 
-            do {
-                /* We want the type and the detail string, which is actually what a Throwable toString() does by
-                 * default, as does the default printStackTrace(). */
-                jint ii;
-
-                jarray stackTrace;
-                jint stackTraceElements;
-                jint lastElementToPrint;
-                jint enclosingIndex;
+/**
+ * Formats the message of a Java exception: the result of its toString() method or, if verbose is set,
+ * its stack trace including all causes. Returns a new reference, or NULL if an error occurred.
+ */
+PyObject* JException_FormatMessage(JNIEnv* jenv, jthrowable error, int verbose)
+{
+    PyObject* pyMessage = NULL;
+    jstring message;
+    int allocError = 0;
+
+    if (verbose) {
+        char *stackTraceString;
+        size_t stackTraceLength = 0;
+        jthrowable cause = error;
+        jarray enclosingElements = NULL;
+        jint enclosingSize = 0;
+
+        stackTraceString = strdup("");
+
+        do {
+            /* We want the type and the detail string, which is actually what a Throwable toString() does by
+             * default, as does the default printStackTrace(). */
+            jint ii;
+
+            jarray stackTrace;
+            jint stackTraceElements;
+            jint lastElementToPrint;
+            jint enclosingIndex;
+
+            if (stackTraceLength > 0) {
+                char *newStackString;
+
+                newStackString = realloc(stackTraceString, CAUSED_BY_STRLEN + 1 + stackTraceLength);
+                if (newStackString == NULL) {
+                    allocError = 1;
+                    break;
+                }
+                stackTraceString = newStackString;
+                strcat(stackTraceString, CAUSED_BY_STRING);
+                stackTraceLength += CAUSED_BY_STRLEN;
+            }
 
-                if (stackTraceLength > 0) {
+            message = (jstring) (*jenv)->CallObjectMethod(jenv, cause, JPy_Object_ToString_MID);
+            if (message != NULL) {
+                const char *messageChars = (*jenv)->GetStringUTFChars(jenv, message, NULL);
+                if (messageChars != NULL) {
                     char *newStackString;
+                    size_t len = strlen(messageChars);
 
-                    newStackString = realloc(stackTraceString, CAUSED_BY_STRLEN + 1 + stackTraceLength);
+                    newStackString = realloc(stackTraceString, len + 2 + stackTraceLength);
                     if (newStackString == NULL) {
+                        (*jenv)->ReleaseStringUTFChars(jenv, message, messageChars);
                         allocError = 1;
                         break;
                     }
+
                     stackTraceString = newStackString;
-                    strcat(stackTraceString, CAUSED_BY_STRING);
-                    stackTraceLength += CAUSED_BY_STRLEN;
+                    strcat(stackTraceString, messageChars);
+                    stackTraceString[stackTraceLength + len] = '\n';
+                    stackTraceString[stackTraceLength + len + 1] = '\0';
+                    stackTraceLength += (len + 1);
+
+                    (*jenv)->ReleaseStringUTFChars(jenv, message, messageChars);
+                } else {
+                    allocError = 1;
+                    break;
+                }
+                (*jenv)->DeleteLocalRef(jenv, message);
+            }
+
+            /* We should assemble a string based on the stack trace. */
+            stackTrace = (*jenv)->CallObjectMethod(jenv, cause, JPy_Throwable_getStackTrace_MID);
+            stackTraceElements = (*jenv)->GetArrayLength(jenv, stackTrace);
+            lastElementToPrint = stackTraceElements - 1;
+            enclosingIndex = enclosingSize - 1;
+
+            while (lastElementToPrint >= 0 && enclosingIndex >= 0) {
+                jobject thisElement = (*jenv)->GetObjectArrayElement(jenv, stackTrace, lastElementToPrint);
+                jobject thatElement = (*jenv)->GetObjectArrayElement(jenv, enclosingElements, enclosingIndex);
+
+                // if they are equal, let's decrement, otherwise we break
+                jboolean  equal = (*jenv)->CallBooleanMethod(jenv, thisElement, JPy_Object_Equals_MID, thatElement);
+                if (!equal) {
+                    break;
                 }
 
-                message = (jstring) (*jenv)->CallObjectMethod(jenv, cause, JPy_Object_ToString_MID);
-                if (message != NULL) {
-                    const char *messageChars = (*jenv)->GetStringUTFChars(jenv, message, NULL);
-                    if (messageChars != NULL) {
+                lastElementToPrint--;
+                enclosingIndex--;
+            }
+
+            for (ii = 0; ii <= lastElementToPrint; ++ii) {
+                jobject traceElement = (*jenv)->GetObjectArrayElement(jenv, stackTrace, ii);
+                if (traceElement != NULL) {
+                    message = (jstring) (*jenv)->CallObjectMethod(jenv, traceElement, JPy_Object_ToString_MID);
+                    if (message != NULL) {
+                        size_t len;
                         char *newStackString;
-                        size_t len = strlen(messageChars);
+                        const char *messageChars = (*jenv)->GetStringUTFChars(jenv, message, NULL);
+                        if (messageChars == NULL) {
+                            allocError = 1;
+                            break;
+                        }
 
-                        newStackString = realloc(stackTraceString, len + 2 + stackTraceLength);
+                        len = strlen(messageChars);
+
+                        newStackString = realloc(stackTraceString, len + 2 + AT_STRLEN + stackTraceLength);
                         if (newStackString == NULL) {
                             (*jenv)->ReleaseStringUTFChars(jenv, message, messageChars);
                             allocError = 1;
@@ -1124,129 +1744,276 @@ void JPy_HandleJavaException(JNIEnv* jenv)
                         }
 
                         stackTraceString = newStackString;
+                        strcat(stackTraceString, AT_STRING);
                         strcat(stackTraceString, messageChars);
-                        stackTraceString[stackTraceLength + len] = '\n';
-                        stackTraceString[stackTraceLength + len + 1] = '\0';
-                        stackTraceLength += (len + 1);
+                        stackTraceString[stackTraceLength + len + AT_STRLEN] = '\n';
+                        stackTraceString[stackTraceLength + len + AT_STRLEN + 1] = '\0';
+                        stackTraceLength += (len + 1 + AT_STRLEN);
 
                         (*jenv)->ReleaseStringUTFChars(jenv, message, messageChars);
-                    } else {
-                        allocError = 1;
-                        break;
-                    }
-                    (*jenv)->DeleteLocalRef(jenv, message);
-                }
-
-                /* We should assemble a string based on the stack trace. */
-                stackTrace = (*jenv)->CallObjectMethod(jenv, cause, JPy_Throwable_getStackTrace_MID);
-                stackTraceElements = (*jenv)->GetArrayLength(jenv, stackTrace);
-                lastElementToPrint = stackTraceElements - 1;
-                enclosingIndex = enclosingSize - 1;
-
-                while (lastElementToPrint >= 0 && enclosingIndex >= 0) {
-                    jobject thisElement = (*jenv)->GetObjectArrayElement(jenv, stackTrace, lastElementToPrint);
-                    jobject thatElement = (*jenv)->GetObjectArrayElement(jenv, enclosingElements, enclosingIndex);
-
-                    // if they are equal, let's decrement, otherwise we break
-                    jboolean  equal = (*jenv)->CallBooleanMethod(jenv, thisElement, JPy_Object_Equals_MID, thatElement);
-                    if (!equal) {
-                        break;
                     }
 
-                    lastElementToPrint--;
-                    enclosingIndex--;
                 }
+            }
 
-                for (ii = 0; ii <= lastElementToPrint; ++ii) {
-                    jobject traceElement = (*jenv)->GetObjectArrayElement(jenv, stackTrace, ii);
-                    if (traceElement != NULL) {
-                        message = (jstring) (*jenv)->CallObjectMethod(jenv, traceElement, JPy_Object_ToString_MID);
-                        if (message != NULL) {
-                            size_t len;
-                            char *newStackString;
-                            const char *messageChars = (*jenv)->GetStringUTFChars(jenv, message, NULL);
-                            if (messageChars == NULL) {
-                                allocError = 1;
-                                break;
-                            }
-
-                            len = strlen(messageChars);
-
-                            newStackString = realloc(stackTraceString, len + 2 + AT_STRLEN + stackTraceLength);
-                            if (newStackString == NULL) {
-                                (*jenv)->ReleaseStringUTFChars(jenv, message, messageChars);
-                                allocError = 1;
-                                break;
-                            }
-
-                            stackTraceString = newStackString;
-                            strcat(stackTraceString, AT_STRING);
-                            strcat(stackTraceString, messageChars);
-                            stackTraceString[stackTraceLength + len + AT_STRLEN] = '\n';
-                            stackTraceString[stackTraceLength + len + AT_STRLEN + 1] = '\0';
-                            stackTraceLength += (len + 1 + AT_STRLEN);
-
-                            (*jenv)->ReleaseStringUTFChars(jenv, message, messageChars);
-                        }
-
-                    }
+            if (lastElementToPrint < stackTraceElements - 1) {
+                int written;
+                char *newStackString = realloc(stackTraceString, stackTraceLength + ELIDED_STRING_MAX_SIZE);
+                if (newStackString == NULL) {
+                    allocError = 1;
+                    break;
                 }
 
-                if (lastElementToPrint < stackTraceElements - 1) {
-                    int written;
-                    char *newStackString = realloc(stackTraceString, stackTraceLength + ELIDED_STRING_MAX_SIZE);
-                    if (newStackString == NULL) {
-                        allocError = 1;
-                        break;
-                    }
-
-                    stackTraceString = newStackString;
-                    stackTraceString[stackTraceLength + ELIDED_STRING_MAX_SIZE - 1] = '\0';
+                stackTraceString = newStackString;
+                stackTraceString[stackTraceLength + ELIDED_STRING_MAX_SIZE - 1] = '\0';
 
-                    written = snprintf(stackTraceString + stackTraceLength, ELIDED_STRING_MAX_SIZE - 1, "\t... %d more\n", (stackTraceElements - lastElementToPrint) - 1);
-                    if (written > (ELIDED_STRING_MAX_SIZE - 1)) {
-                        stackTraceLength += (ELIDED_STRING_MAX_SIZE - 1);
-                    } else {
-                        stackTraceLength += written;
-                    }
+                written = snprintf(stackTraceString + stackTraceLength, ELIDED_STRING_MAX_SIZE - 1, "\t... %d more\n", (stackTraceElements - lastElementToPrint) - 1);
+                if (written > (ELIDED_STRING_MAX_SIZE - 1)) {
+                    stackTraceLength += (ELIDED_STRING_MAX_SIZE - 1);
+                } else {
+                    stackTraceLength += written;
                 }
+            }
 
-                /** So we can eliminate extra entries. */
-                enclosingElements = stackTrace;
-                enclosingSize = stackTraceElements;
+            /** So we can eliminate extra entries. */
+            enclosingElements = stackTrace;
+            enclosingSize = stackTraceElements;
 
-                /** Now the next cause. */
-                cause = (*jenv)->CallObjectMethod(jenv, cause, JPy_Throwable_getCause_MID);
-            } while (cause != NULL && !allocError);
+            /** Now the next cause. */
+            cause = (*jenv)->CallObjectMethod(jenv, cause, JPy_Throwable_getCause_MID);
+        } while (cause != NULL && !allocError);
 
-            if (allocError == 0 && stackTraceString != NULL) {
-                PyErr_Format(PyExc_RuntimeError, "%s", stackTraceString);
+        if (allocError == 0 && stackTraceString != NULL) {
+            pyMessage = JPy_FROM_CSTR(stackTraceString);
+        } else {
+            PyErr_SetString(PyExc_RuntimeError,
+                            "Java VM exception occurred, but failed to allocate message text");
+        }
+        free(stackTraceString);
+    } else {
+        message = (jstring) (*jenv)->CallObjectMethod(jenv, error, JPy_Object_ToString_MID);
+        if (message != NULL) {
+            const char *messageChars;
+
+            messageChars = (*jenv)->GetStringUTFChars(jenv, message, NULL);
+            if (messageChars != NULL) {
+                pyMessage = JPy_FROM_CSTR(messageChars);
+                (*jenv)->ReleaseStringUTFChars(jenv, message, messageChars);
             } else {
                 PyErr_SetString(PyExc_RuntimeError,
                                 "Java VM exception occurred, but failed to allocate message text");
             }
-            free(stackTraceString);
+            (*jenv)->DeleteLocalRef(jenv, message);
         } else {
-            message = (jstring) (*jenv)->CallObjectMethod(jenv, error, JPy_Object_ToString_MID);
-            if (message != NULL) {
-                const char *messageChars;
+            (*jenv)->ExceptionClear(jenv);
+            pyMessage = JPy_FROM_CSTR("Java VM exception occurred, no message");
+        }
+    }
 
-                messageChars = (*jenv)->GetStringUTFChars(jenv, message, NULL);
-                if (messageChars != NULL) {
-                    PyErr_Format(PyExc_RuntimeError, "%s", messageChars);
-                    (*jenv)->ReleaseStringUTFChars(jenv, message, messageChars);
-                } else {
-                    PyErr_SetString(PyExc_RuntimeError,
-                                    "Java VM exception occurred, but failed to allocate message text");
-                }
-                (*jenv)->DeleteLocalRef(jenv, message);
-            } else {
-                PyErr_SetString(PyExc_RuntimeError, "Java VM exception occurred, no message");
+    return pyMessage;
+}
+
+/**
+ * Formats the message of a jpy.JException instance and stores it as the exception's args.
+ */
+int JException_FormatArgs(PyObject* self)
+{
+    JNIEnv* jenv;
+    PyBaseExceptionObject* pyBaseException;
+    PyObject* pyJavaException;
+    PyObject* pyVerbose;
+    PyObject* pyMessage;
+    PyObject* pyArgs;
+    int verbose;
+
+    JPy_GET_JNI_ENV_OR_RETURN(jenv, -1)
+
+    pyJavaException = PyObject_GetAttrString(self, JPy_JEXCEPTION_ATTR_JAVA_EXCEPTION);
+    if (pyJavaException == NULL) {
+        if (PyErr_ExceptionMatches(PyExc_AttributeError)) {
+            // Raised by Python code, so there is nothing to format
+            PyErr_Clear();
+            return 0;
+        }
+        return -1;
+    }
+    if (!JObj_Check(pyJavaException)) {
+        Py_DECREF(pyJavaException);
+        PyErr_SetString(PyExc_TypeError, "jpy.JException: '" JPy_JEXCEPTION_ATTR_JAVA_EXCEPTION "' must be a Java object");
+        return -1;
+    }
+
+    pyVerbose = PyObject_GetAttrString(self, JPy_JEXCEPTION_ATTR_VERBOSE);
+    if (pyVerbose != NULL) {
+        verbose = PyObject_IsTrue(pyVerbose);
+        Py_DECREF(pyVerbose);
+    } else {
+        PyErr_Clear();
+        verbose = JPy_VerboseExceptions;
+    }
+
+    pyMessage = JException_FormatMessage(jenv, ((JPy_JObj*) pyJavaException)->objectRef, verbose);
+    Py_DECREF(pyJavaException);
+    if (pyMessage == NULL) {
+        return -1;
+    }
+
+    pyArgs = PyTuple_Pack(1, pyMessage);
+    Py_DECREF(pyMessage);
+    if (pyArgs == NULL) {
+        return -1;
+    }
+
+    pyBaseException = (PyBaseExceptionObject*) self;
+    Py_XDECREF(pyBaseException->args);
+    pyBaseException->args = pyArgs;
+    return 0;
+}
+
+/**
+ * Implements the 'args' attribute of jpy.JException, which holds the message once it has been formatted.
+ */
+PyObject* JException_getargs(PyObject* self, void* closure)
+{
+    PyBaseExceptionObject* pyBaseException = (PyBaseExceptionObject*) self;
+    if (pyBaseException->args == NULL || PyTuple_GET_SIZE(pyBaseException->args) == 0) {
+        if (JException_FormatArgs(self) < 0) {
+            return NULL;
+        }
+    }
+    Py_INCREF(pyBaseException->args);
+    return pyBaseException->args;
+}
+
+int JException_setargs(PyObject* self, PyObject* value, void* closure)
+{
+    PyBaseExceptionObject* pyBaseException = (PyBaseExceptionObject*) self;
+    PyObject* pyArgs;
+
+    if (value == NULL) {
+        PyErr_SetString(PyExc_TypeError, "args may not be deleted");
+        return -1;
+    }
+    pyArgs = PySequence_Tuple(value);
+    if (pyArgs == NULL) {
+        return -1;
+    }
+    Py_XDECREF(pyBaseException->args);
+    pyBaseException->args = pyArgs;
+    return 0;
+}
+
+PyObject* JException_str(PyObject* self, PyObject* noArgs)
+{
+    PyObject* pyArgs;
+    PyObject* pyStr;
+
+    pyArgs = JException_getargs(self, NULL);
+    if (pyArgs == NULL) {
+        return NULL;
+    }
+    if (PyTuple_GET_SIZE(pyArgs) == 0) {
+        pyStr = JPy_FROM_CSTR("");
+    } else if (PyTuple_GET_SIZE(pyArgs) == 1) {
+        pyStr = PyObject_Str(PyTuple_GET_ITEM(pyArgs, 0));
+    } else {
+        pyStr = PyObject_Str(pyArgs);
+    }
+    Py_DECREF(pyArgs);
+    return pyStr;
+}
+
+static PyMethodDef JException_str_MethodDef = {
+    "__str__", (PyCFunction) JException_str, METH_NOARGS, "Returns the message of the Java exception."
+};
+
+static PyGetSetDef JException_args_GetSetDef = {
+    "args", (getter) JException_getargs, (setter) JException_setargs, "The message of the Java exception.", NULL
+};
+
+/**
+ * Creates the type jpy.JException, the RuntimeError raised for Java exceptions. Its instances refer
+ * to the Java exception by the attribute 'java_exception'. Their message is formatted when first needed.
+ */
+PyObject* JException_NewType(void)
+{
+    PyObject* type;
+    PyObject* descr;
+
+    type = PyErr_NewException("jpy.JException", PyExc_RuntimeError, NULL);
+    if (type == NULL) {
+        return NULL;
+    }
+
+    descr = PyDescr_NewMethod((PyTypeObject*) type, &JException_str_MethodDef);
+    if (descr == NULL || PyObject_SetAttrString(type, "__str__", descr) < 0) {
+        Py_XDECREF(descr);
+        Py_DECREF(type);
+        return NULL;
+    }
+    Py_DECREF(descr);
+
+    descr = PyDescr_NewGetSet((PyTypeObject*) type, &JException_args_GetSetDef);
+    if (descr == NULL || PyObject_SetAttrString(type, "args", descr) < 0) {
+        Py_XDECREF(descr);
+        Py_DECREF(type);
+        return NULL;
+    }
+    Py_DECREF(descr);
+
+    return type;
+}
+
+/**
+ * Raises a jpy.JException for the given Java exception, which must no longer be pending.
+ */
+void JException_Raise(JNIEnv* jenv, jthrowable error)
+{
+    PyObject* pyJavaException;
+    PyObject* pyException;
+
+    // The JObj holds a global reference to the Java exception
+    pyJavaException = JPy_FromJObject(jenv, error);
+    if (pyJavaException == NULL) {
+        return;
+    }
+
+    pyException = PyObject_CallObject(JException_Type, NULL);
+    if (pyException == NULL) {
+        Py_DECREF(pyJavaException);
+        return;
+    }
+
+    if (PyObject_SetAttrString(pyException, JPy_JEXCEPTION_ATTR_JAVA_EXCEPTION, pyJavaException) == 0
+        && PyObject_SetAttrString(pyException, JPy_JEXCEPTION_ATTR_VERBOSE, JPy_VerboseExceptions ? Py_True : Py_False) == 0) {
+        PyErr_SetObject(JException_Type, pyException);
+    }
+
+    Py_DECREF(pyException);
+    Py_DECREF(pyJavaException);
+}
+
+void JPy_HandleJavaException(JNIEnv* jenv)
+{
+    jthrowable error = (*jenv)->ExceptionOccurred(jenv);
+    if (error != NULL) {
+        if (JPy_DiagFlags != 0) {
+            (*jenv)->ExceptionDescribe(jenv);
+        }
+        (*jenv)->ExceptionClear(jenv);
+
+        if (JException_Type != NULL) {
+            // The message is only formatted once the Python exception is printed or its args are accessed
+            JException_Raise(jenv, error);
+        } else {
+            PyObject* pyMessage = JException_FormatMessage(jenv, error, JPy_VerboseExceptions);
+            if (pyMessage != NULL) {
+                PyErr_SetObject(PyExc_RuntimeError, pyMessage);
+                Py_DECREF(pyMessage);
             }
         }
 
         (*jenv)->DeleteLocalRef(jenv, error);
-        (*jenv)->ExceptionClear(jenv);
     }
 }
 
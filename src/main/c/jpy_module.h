@@ -40,6 +40,9 @@ extern PyObject* JException_Type;
 
 extern JavaVM* JPy_JVM;
 extern jboolean JPy_MustDestroyJVM;
+extern int JPy_AttachAsDaemon;
+extern long JPy_AttachedThreadCount;
+extern long JPy_DetachedThreadCount;
 
 
 #define JPy_JTYPE_ATTR_NAME_JINIT "__jinit__"
@@ -75,11 +78,37 @@ void JPy_ClearGlobalVars(JNIEnv* jenv);
     }
 
 
+/**
+ * A process-wide recursive lock guarding jpy's global mutable state, such as the registration of new
+ * Java types in JPy_Types, which would otherwise be guarded by the GIL.
+ * Only needed in free-threaded Python builds, the macros do nothing otherwise.
+ */
+#if defined(JPY_FREE_THREADED)
+void JPy_LockGlobals(void);
+void JPy_UnlockGlobals(void);
+#define JPy_BEGIN_GLOBALS_LOCK JPy_LockGlobals();
+#define JPy_END_GLOBALS_LOCK   JPy_UnlockGlobals();
+#else
+#define JPy_BEGIN_GLOBALS_LOCK
+#define JPy_END_GLOBALS_LOCK
+#endif
+
+/**
+ * Returns a new reference to the value of the given key in the given dictionary, or NULL if there is none.
+ * Unlike PyDict_GetItemString(), the value can't be released by other threads in free-threaded Python builds.
+ */
+PyObject* JPy_GetDictItemStringRef(PyObject* dict, const char* key);
+
 /**
  * Fetches the last Java exception occurred and raises a new Python exception.
  */
 void JPy_HandleJavaException(JNIEnv* jenv);
 
+/**
+ * Raises a jpy.JException for the given Java exception, which must no longer be pending.
+ */
+void JException_Raise(JNIEnv* jenv, jthrowable error);
+
 
 #define JPy_ON_JAVA_EXCEPTION_GOTO(LABEL) \
     if ((*jenv)->ExceptionCheck(jenv)) { \
@@ -159,6 +188,7 @@ extern jclass JPy_Map_Entry_JClass;
 extern jmethodID JPy_Map_entrySet_MID;
 extern jmethodID JPy_Map_put_MID;
 extern jmethodID JPy_Map_clear_MID;
+extern jmethodID JPy_Map_remove_MID;
 extern jmethodID JPy_Map_Entry_getKey_MID;
 extern jmethodID JPy_Map_Entry_getValue_MID;
 // java.util.Set
@@ -169,12 +199,23 @@ extern jclass JPy_Iterator_JClass;
 extern jmethodID JPy_Iterator_next_MID;
 extern jmethodID JPy_Iterator_hasNext_MID;
 
+extern jclass JPy_Buffer_JClass;
+extern jmethodID JPy_Buffer_IsReadOnly_MID;
+
+// java.util.concurrent.CompletionStage and java.util.concurrent.Future, awaitable in Python
+extern jclass JPy_CompletionStage_JClass;
+extern jclass JPy_Future_JClass;
+
 extern jclass JPy_RuntimeException_JClass;
 extern jclass JPy_OutOfMemoryError_JClass;
 extern jclass JPy_FileNotFoundException_JClass;
 extern jclass JPy_UnsupportedOperationException_JClass;
+extern jclass JPy_PyException_JClass;
 extern jclass JPy_KeyError_JClass;
 extern jclass JPy_StopIteration_JClass;
+extern jmethodID JPy_PyException_Init_MID;
+extern jmethodID JPy_KeyError_Init_MID;
+extern jmethodID JPy_StopIteration_Init_MID;
 
 extern jclass JPy_Boolean_JClass;
 extern jmethodID JPy_Boolean_Init_MID;
@@ -217,6 +258,17 @@ extern jmethodID JPy_PyObject_Init_MID;
 extern jclass JPy_PyDictWrapper_JClass;
 extern jmethodID JPy_PyDictWrapper_GetPointer_MID;
 
+// Parameter flags returned by org.jpy.annotations.ParamAnnotations.getFlags()
+#define JPy_PARAM_FLAG_MUTABLE 0x01
+#define JPy_PARAM_FLAG_OUTPUT  0x02
+#define JPy_PARAM_FLAG_RETURN  0x04
+
+extern jclass JPy_ParamAnnotations_JClass;
+extern jmethodID JPy_ParamAnnotations_GetFlags_MID;
+
+extern jclass JPy_PyFutures_JClass;
+extern jmethodID JPy_PyFutures_WhenComplete_SMID;
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -0,0 +1,377 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "jpy_module.h"
+#include "jpy_diag.h"
+#include "jpy_watchdog.h"
+
+#if !defined(_WIN32) && !defined(__CYGWIN__)
+#include <dlfcn.h>
+#endif
+
+// Tracking is kept cheap enough to be left on: each thread owns a slot, claimed once, and a GIL wait only
+// increments the slot's counter twice. The Java watchdog polls the slots and measures how long a counter
+// stays odd. Slots are only written by their own threads, or when claimed and released under JWatchdog_Lock.
+
+#define JWatchdog_MAX_SLOTS 1024
+
+typedef struct {
+    // The ID of the Java thread owning the slot, 0 if free, -1 for a virtual thread (unknown ID)
+    volatile jlong threadId;
+    // Incremented when the thread begins and ends waiting for the GIL, so odd while waiting
+    volatile jlong waits;
+} JWatchdog_Slot;
+
+volatile int JPy_WatchdogEnabled = 0;
+
+static JWatchdog_Slot JWatchdog_Slots[JWatchdog_MAX_SLOTS];
+// The number of slots in use so far, free slots below are reused first
+static volatile int JWatchdog_SlotCount = 0;
+// Set if a slot could not be claimed, reset once slots have been released
+static volatile int JWatchdog_SlotsExhausted = 0;
+static PyThread_type_lock JWatchdog_Lock = NULL;
+
+// The slot of the thread holding the GIL while running Java code, -1 if none or unknown.
+// Only written by threads holding the GIL.
+static volatile int JWatchdog_HolderSlot = -1;
+// Incremented whenever the GIL holder enters or exits Java code
+static volatile jlong JWatchdog_HolderChanges = 0;
+
+static JPy_THREAD_LOCAL int JWatchdog_ThreadSlot = -1;
+static JPy_THREAD_LOCAL jlong JWatchdog_ThreadId = 0;
+
+static jclass JWatchdog_Thread_JClass = NULL;
+static jmethodID JWatchdog_Thread_CurrentThread_SMID = NULL;
+static jmethodID JWatchdog_Thread_GetId_MID = NULL;
+// Thread.isVirtual(), NULL before Java 21
+static jmethodID JWatchdog_Thread_IsVirtual_MID = NULL;
+
+
+/**
+ * Returns the ID of the current Java thread, -1 for a virtual thread, whose native thread
+ * (the carrier) may run other virtual threads later, or 0 on failure.
+ */
+static jlong JWatchdog_GetCurrentThreadId(JNIEnv* jenv)
+{
+    jobject jThread;
+    jlong threadId;
+
+    if ((*jenv)->ExceptionCheck(jenv)) {
+        return 0;
+    }
+    jThread = (*jenv)->CallStaticObjectMethod(jenv, JWatchdog_Thread_JClass, JWatchdog_Thread_CurrentThread_SMID);
+    if (jThread == NULL) {
+        (*jenv)->ExceptionClear(jenv);
+        return 0;
+    }
+    if (JWatchdog_Thread_IsVirtual_MID != NULL && (*jenv)->CallBooleanMethod(jenv, jThread, JWatchdog_Thread_IsVirtual_MID)) {
+        threadId = -1;
+    } else {
+        threadId = (*jenv)->CallLongMethod(jenv, jThread, JWatchdog_Thread_GetId_MID);
+    }
+    (*jenv)->DeleteLocalRef(jenv, jThread);
+    if ((*jenv)->ExceptionCheck(jenv)) {
+        (*jenv)->ExceptionClear(jenv);
+        return 0;
+    }
+    return threadId;
+}
+
+/**
+ * Returns the slot of the current thread, claiming one if needed, or -1 if no slot is available.
+ */
+static int JWatchdog_GetSlot(JNIEnv* jenv)
+{
+    int slot;
+    int i;
+
+    slot = JWatchdog_ThreadSlot;
+    // The slot may have been released by the Java watchdog if the Java thread has terminated
+    if (slot >= 0 && JWatchdog_Slots[slot].threadId == JWatchdog_ThreadId) {
+        return slot;
+    }
+    JWatchdog_ThreadSlot = -1;
+    if (JWatchdog_SlotsExhausted || JWatchdog_Lock == NULL) {
+        return -1;
+    }
+
+    if (JWatchdog_ThreadId == 0) {
+        JWatchdog_ThreadId = JWatchdog_GetCurrentThreadId(jenv);
+        if (JWatchdog_ThreadId == 0) {
+            return -1;
+        }
+    }
+
+    slot = -1;
+    PyThread_acquire_lock(JWatchdog_Lock, WAIT_LOCK);
+    for (i = 0; i < JWatchdog_SlotCount; i++) {
+        if (JWatchdog_Slots[i].threadId == 0) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot < 0 && JWatchdog_SlotCount < JWatchdog_MAX_SLOTS) {
+        slot = JWatchdog_SlotCount++;
+    }
+    if (slot >= 0) {
+        JWatchdog_Slots[slot].waits = 0;
+        JWatchdog_Slots[slot].threadId = JWatchdog_ThreadId;
+    } else {
+        JWatchdog_SlotsExhausted = 1;
+    }
+    PyThread_release_lock(JWatchdog_Lock);
+
+    JWatchdog_ThreadSlot = slot;
+    return slot;
+}
+
+int JWatchdog_BeginGilWait(JNIEnv* jenv)
+{
+    int slot = JWatchdog_GetSlot(jenv);
+    if (slot >= 0) {
+        JWatchdog_Slots[slot].waits++;
+    }
+    return slot;
+}
+
+void JWatchdog_EndGilWait(int slot)
+{
+    if (slot >= 0) {
+        JWatchdog_Slots[slot].waits++;
+    }
+}
+
+int JWatchdog_EnterJava(JNIEnv* jenv)
+{
+    int previousHolder = JWatchdog_HolderSlot;
+#if !defined(JPY_FREE_THREADED)
+    JWatchdog_HolderSlot = JWatchdog_GetSlot(jenv);
+    JWatchdog_HolderChanges++;
+#endif
+    return previousHolder;
+}
+
+void JWatchdog_ExitJava(int previousHolder)
+{
+#if !defined(JPY_FREE_THREADED)
+    JWatchdog_HolderSlot = previousHolder;
+    JWatchdog_HolderChanges++;
+#endif
+}
+
+void JWatchdog_ReleaseThread(void)
+{
+    int slot = JWatchdog_ThreadSlot;
+
+    JWatchdog_ThreadSlot = -1;
+    JWatchdog_ThreadId = 0;
+    if (slot < 0 || JWatchdog_Lock == NULL) {
+        return;
+    }
+    PyThread_acquire_lock(JWatchdog_Lock, WAIT_LOCK);
+    JWatchdog_Slots[slot].threadId = 0;
+    JWatchdog_SlotsExhausted = 0;
+    PyThread_release_lock(JWatchdog_Lock);
+}
+
+jboolean JWatchdog_SetEnabled(JNIEnv* jenv, jboolean enabled)
+{
+    jclass classRef;
+
+    if (enabled && JWatchdog_Thread_JClass == NULL) {
+        classRef = (*jenv)->FindClass(jenv, "java/lang/Thread");
+        if (classRef == NULL) {
+            return JNI_FALSE;
+        }
+        JWatchdog_Thread_CurrentThread_SMID = (*jenv)->GetStaticMethodID(jenv, classRef, "currentThread", "()Ljava/lang/Thread;");
+        JWatchdog_Thread_GetId_MID = (*jenv)->GetMethodID(jenv, classRef, "getId", "()J");
+        if (JWatchdog_Thread_CurrentThread_SMID == NULL || JWatchdog_Thread_GetId_MID == NULL) {
+            return JNI_FALSE;
+        }
+        JWatchdog_Thread_IsVirtual_MID = (*jenv)->GetMethodID(jenv, classRef, "isVirtual", "()Z");
+        if (JWatchdog_Thread_IsVirtual_MID == NULL) {
+            (*jenv)->ExceptionClear(jenv);
+        }
+        if (JWatchdog_Lock == NULL) {
+            JWatchdog_Lock = PyThread_allocate_lock();
+            if (JWatchdog_Lock == NULL) {
+                return JNI_FALSE;
+            }
+        }
+        JWatchdog_Thread_JClass = (*jenv)->NewGlobalRef(jenv, classRef);
+    }
+    JPy_WatchdogEnabled = enabled ? 1 : 0;
+    JPy_DIAG_PRINT(JPy_DIAG_F_EXEC, "JWatchdog_SetEnabled: enabled=%d\n", JPy_WatchdogEnabled);
+    return JNI_TRUE;
+}
+
+/**
+ * Returns the tracked state as a Java long[]: the ID of the Java thread holding the GIL while running Java code
+ * (0 if none or unknown), the number of changes of that holder, 1 if slots are exhausted (else 0), followed by
+ * (slot, thread ID, number of waits) triples of all slots in use. Doesn't require the GIL.
+ */
+jlongArray JWatchdog_GetState(JNIEnv* jenv)
+{
+    jlong values[3 + 3 * JWatchdog_MAX_SLOTS];
+    jlongArray jValues;
+    jsize count;
+    int holder;
+    int slotCount;
+    int i;
+
+    holder = JWatchdog_HolderSlot;
+    values[0] = holder >= 0 ? JWatchdog_Slots[holder].threadId : 0;
+    values[1] = JWatchdog_HolderChanges;
+    values[2] = JWatchdog_SlotsExhausted;
+    count = 3;
+    slotCount = JWatchdog_SlotCount;
+    for (i = 0; i < slotCount; i++) {
+        jlong threadId = JWatchdog_Slots[i].threadId;
+        if (threadId != 0) {
+            values[count++] = i;
+            values[count++] = threadId;
+            values[count++] = JWatchdog_Slots[i].waits;
+        }
+    }
+
+    jValues = (*jenv)->NewLongArray(jenv, count);
+    if (jValues != NULL) {
+        (*jenv)->SetLongArrayRegion(jenv, jValues, 0, count, values);
+    }
+    return jValues;
+}
+
+/**
+ * Releases the slots of the given Java threads, which must have terminated.
+ */
+void JWatchdog_ReleaseThreads(JNIEnv* jenv, jlongArray jThreadIds)
+{
+    jlong* threadIds;
+    jsize length;
+    jsize j;
+    int i;
+
+    if (JWatchdog_Lock == NULL) {
+        return;
+    }
+    length = (*jenv)->GetArrayLength(jenv, jThreadIds);
+    threadIds = (*jenv)->GetLongArrayElements(jenv, jThreadIds, NULL);
+    if (threadIds == NULL) {
+        return;
+    }
+    PyThread_acquire_lock(JWatchdog_Lock, WAIT_LOCK);
+    for (i = 0; i < JWatchdog_SlotCount; i++) {
+        for (j = 0; j < length; j++) {
+            if (threadIds[j] > 0 && JWatchdog_Slots[i].threadId == threadIds[j]) {
+                JWatchdog_Slots[i].threadId = 0;
+                break;
+            }
+        }
+    }
+    JWatchdog_SlotsExhausted = 0;
+    PyThread_release_lock(JWatchdog_Lock);
+    (*jenv)->ReleaseLongArrayElements(jenv, jThreadIds, threadIds, JNI_ABORT);
+}
+
+/**
+ * Called by the main thread holding the GIL, if the stacks could not be dumped without it.
+ */
+static int JWatchdog_DumpPythonStacksLater(void* arg)
+{
+    PyObject* pyModule;
+    PyObject* pyResult = NULL;
+    PyObject* pyFile;
+
+    pyModule = PyImport_ImportModule("faulthandler");
+    pyFile = PySys_GetObject("stderr");
+    if (pyModule != NULL && pyFile != NULL) {
+        pyResult = PyObject_CallMethod(pyModule, "dump_traceback", "Oi", pyFile, 1);
+    }
+    Py_XDECREF(pyResult);
+    Py_XDECREF(pyModule);
+    // An error returned here would be raised in the code the main thread happens to run
+    PyErr_Clear();
+    return 0;
+}
+
+#if PY_VERSION_HEX >= 0x03060000 && !defined(_WIN32) && !defined(__CYGWIN__)
+
+typedef const char* (*JWatchdog_DumpTracebackThreads)(int fd, PyInterpreterState* interp, PyThreadState* current_tstate);
+
+/**
+ * Dumps the stacks of all Python threads into a string without acquiring the GIL,
+ * using the function behind faulthandler.dump_traceback_later(), if the Python library exports it.
+ */
+static jstring JWatchdog_DumpPythonStacksNow(JNIEnv* jenv)
+{
+    JWatchdog_DumpTracebackThreads dumpTracebackThreads;
+    const char* error;
+    FILE* file;
+    long size;
+    char* text;
+    jstring jText;
+
+    dumpTracebackThreads = (JWatchdog_DumpTracebackThreads) dlsym(RTLD_DEFAULT, "_Py_DumpTracebackThreads");
+    if (dumpTracebackThreads == NULL) {
+        return NULL;
+    }
+    file = tmpfile();
+    if (file == NULL) {
+        return NULL;
+    }
+    // Writes to the file descriptor directly, just like faulthandler's signal handlers
+    error = dumpTracebackThreads(fileno(file), NULL, NULL);
+    jText = NULL;
+    if (fseek(file, 0, SEEK_END) == 0 && (size = ftell(file)) >= 0) {
+        text = PyMem_RawMalloc(size + 1);
+        if (text != NULL) {
+            rewind(file);
+            size = (long) fread(text, 1, size, file);
+            text[size] = 0;
+            jText = (*jenv)->NewStringUTF(jenv, error != NULL && size == 0 ? error : text);
+            PyMem_RawFree(text);
+        }
+    }
+    fclose(file);
+    return jText;
+}
+
+#endif
+
+/**
+ * Returns the stacks of all Python threads, or a note if they are written to stderr
+ * by the main thread once it holds the GIL.
+ */
+jstring JWatchdog_DumpPythonStacks(JNIEnv* jenv)
+{
+    jstring jText = NULL;
+
+    if (!Py_IsInitialized()) {
+        return (*jenv)->NewStringUTF(jenv, "Python interpreter not running");
+    }
+#if PY_VERSION_HEX >= 0x03060000 && !defined(_WIN32) && !defined(__CYGWIN__)
+    jText = JWatchdog_DumpPythonStacksNow(jenv);
+#endif
+    if (jText == NULL) {
+        if (Py_AddPendingCall(JWatchdog_DumpPythonStacksLater, NULL) == 0) {
+            jText = (*jenv)->NewStringUTF(jenv, "written to stderr by the main thread once it holds the GIL");
+        } else {
+            jText = (*jenv)->NewStringUTF(jenv, "not available");
+        }
+    }
+    return jText;
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef JPY_WATCHDOG_H
+#define JPY_WATCHDOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "jpy_compat.h"
+
+/**
+ * Non-zero while org.jpy.GilWatchdog runs. Only then threads waiting for the GIL and
+ * the thread holding the GIL while running Java code are tracked.
+ */
+extern volatile int JPy_WatchdogEnabled;
+
+/**
+ * Marks the current thread as waiting for the GIL until JWatchdog_EndGilWait() is called.
+ * Returns the thread's slot to be passed to JWatchdog_EndGilWait().
+ */
+int JWatchdog_BeginGilWait(JNIEnv* jenv);
+void JWatchdog_EndGilWait(int slot);
+
+/**
+ * Marks the current thread, which holds the GIL, as running Java code until JWatchdog_ExitJava() is called.
+ * Returns the previous GIL holder to be passed to JWatchdog_ExitJava().
+ */
+int JWatchdog_EnterJava(JNIEnv* jenv);
+void JWatchdog_ExitJava(int previousHolder);
+
+/**
+ * Releases the slot of the current thread, called before it is detached from the JVM.
+ */
+void JWatchdog_ReleaseThread(void);
+
+jboolean JWatchdog_SetEnabled(JNIEnv* jenv, jboolean enabled);
+jlongArray JWatchdog_GetState(JNIEnv* jenv);
+void JWatchdog_ReleaseThreads(JNIEnv* jenv, jlongArray jThreadIds);
+jstring JWatchdog_DumpPythonStacks(JNIEnv* jenv);
+
+/**
+ * Acquires the GIL like PyGILState_Ensure() and tracks the wait if the watchdog runs.
+ */
+#define JPy_ENSURE_GIL(JENV, STATE) \
+    do { \
+        if (JPy_WatchdogEnabled) { \
+            int waitSlot = JWatchdog_BeginGilWait(JENV); \
+            STATE = PyGILState_Ensure(); \
+            JWatchdog_EndGilWait(waitSlot); \
+        } else { \
+            STATE = PyGILState_Ensure(); \
+        } \
+    } while (0)
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+#endif /* !JPY_WATCHDOG_H */
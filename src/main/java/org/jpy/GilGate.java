@@ -0,0 +1,124 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.jpy;
+
+import java.lang.invoke.MethodHandle;
+import java.lang.invoke.MethodHandles;
+import java.lang.invoke.MethodType;
+import java.util.concurrent.locks.ReentrantLock;
+
+/**
+ * A fair Java-side lock mirroring the ownership of the Python GIL among Java threads opening a {@link GilScope}.
+ * <p>
+ * Threads waiting for the GIL in native code block their OS thread. For virtual threads (Java 21+) this pins the
+ * carrier thread, so a few hundred virtual threads waiting for the GIL exhaust the carrier pool. Gated threads
+ * therefore queue for this lock first, which parks virtual threads in Java without pinning their carrier, and only
+ * the thread at the head of the queue enters native code to acquire the GIL.
+ * <p>
+ * The gate only orders Java threads opening a scope: the owner of the gate may still have to wait for Python
+ * threads or ungated Java threads holding the GIL, but at most one gated thread ever blocks in native code.
+ * Threads already holding the GIL, e.g. Java code called from Python, are never gated: the owner of the gate could
+ * be waiting for their GIL.
+ * <p>
+ * The system property {@code jpy.gilGate} selects the gated threads: {@code virtual} (the default) for virtual
+ * threads only, {@code all} for all threads, and {@code off} for none. Invalid values select the default.
+ *
+ * @see PyLib#acquireGil()
+ * @since 0.10
+ */
+final class GilGate {
+
+    enum Mode {
+        OFF, VIRTUAL, ALL
+    }
+
+    // Not final, so that tests can gate platform threads
+    static volatile Mode mode = parseMode(System.getProperty("jpy.gilGate", "virtual"));
+
+    private static final ReentrantLock LOCK = new ReentrantLock(true);
+    // Thread.isVirtual(), null before Java 21
+    private static final MethodHandle IS_VIRTUAL = findIsVirtual();
+
+    /**
+     * Waits for the gate if the current thread is gated and doesn't hold the GIL yet.
+     *
+     * @return {@code true} if the gate has been entered and must be left by {@link #exit()}.
+     */
+    static boolean enter() {
+        if (!isGated(Thread.currentThread()) || PyLib.hasGil()) {
+            return false;
+        }
+        LOCK.lock();
+        return true;
+    }
+
+    /**
+     * Leaves the gate entered by the current thread.
+     */
+    static void exit() {
+        LOCK.unlock();
+    }
+
+    /**
+     * @return {@code true} if any thread has entered the gate.
+     */
+    static boolean isLocked() {
+        return LOCK.isLocked();
+    }
+
+    static boolean isGated(Thread thread) {
+        switch (mode) {
+            case ALL:
+                return true;
+            case VIRTUAL:
+                return isVirtual(thread);
+            default:
+                return false;
+        }
+    }
+
+    static boolean isVirtual(Thread thread) {
+        if (IS_VIRTUAL == null) {
+            return false;
+        }
+        try {
+            return (boolean) IS_VIRTUAL.invokeExact(thread);
+        } catch (Throwable t) {
+            return false;
+        }
+    }
+
+    static Mode parseMode(String value) {
+        try {
+            return Mode.valueOf(value.trim().toUpperCase());
+        } catch (IllegalArgumentException e) {
+            System.err.printf("org.jpy.GilGate: invalid value '%s' of system property jpy.gilGate, using 'virtual'%n", value);
+            return Mode.VIRTUAL;
+        }
+    }
+
+    private static MethodHandle findIsVirtual() {
+        try {
+            return MethodHandles.publicLookup().findVirtual(Thread.class, "isVirtual", MethodType.methodType(boolean.class));
+        } catch (NoSuchMethodException | IllegalAccessException e) {
+            return null;
+        }
+    }
+
+    private GilGate() {
+    }
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.jpy;
+
+/**
+ * Holds the Python GIL (global interpreter lock) for the current thread until it is closed.
+ * <p>
+ * Each {@link PyLib} call acquires and releases the GIL by itself, and so it competes for the GIL with other
+ * threads on every call. While a {@code GilScope} is open, calls made by the same thread skip acquiring the GIL,
+ * so a sequence of calls runs at full speed:
+ * <pre>
+ *     try (GilScope gil = PyLib.acquireGil()) {
+ *         PyObject value = obj.getAttribute("value");
+ *         int n = obj.callMethod("size").getIntValue();
+ *         ...
+ *     }
+ * </pre>
+ * Other threads can't run Python code while the scope is open. Keep scopes short and don't wait for other
+ * threads calling into Python within a scope, as this will dead-lock.
+ * A scope must be closed by the thread which opened it. Scopes may be nested.
+ * <p>
+ * Virtual threads wait for the GIL in Java rather than in native code, so that they don't pin their carrier
+ * thread meanwhile, see the system property {@code jpy.gilGate}.
+ * <p>
+ * A virtual thread's scope doesn't hold the GIL itself: the native scope state belongs to the carrier thread,
+ * and a virtual thread blocking within the scope (I/O, locks, sleeping) unmounts from its carrier and may resume
+ * on another one. Instead, each call made within a virtual thread's scope acquires the GIL while the thread is
+ * pinned to its carrier by the native call. The scope still holds the gate, so gated virtual threads run their
+ * scopes one after the other, and they may block within a scope. However, other threads may run Python code
+ * between the calls.
+ *
+ * @see PyLib#acquireGil()
+ * @see PyLib#withGil(java.util.function.Supplier)
+ * @since 0.10
+ */
+public final class GilScope implements AutoCloseable {
+
+    private final Thread thread;
+    private final boolean virtual;
+    private final boolean gated;
+    private final long gilState;
+    private boolean closed;
+
+    GilScope() {
+        this.thread = Thread.currentThread();
+        this.virtual = GilGate.isVirtual(thread);
+        this.gated = GilGate.enter();
+        try {
+            this.gilState = virtual ? 0L : PyLib.acquireGil0();
+        } catch (RuntimeException | Error e) {
+            if (gated) {
+                GilGate.exit();
+            }
+            throw e;
+        }
+    }
+
+    /**
+     * Releases the GIL, unless already done.
+     *
+     * @throws IllegalStateException If called from another thread than the one which opened the scope.
+     */
+    @Override
+    public void close() {
+        if (Thread.currentThread() != thread) {
+            throw new IllegalStateException("GilScope must be closed by the thread which opened it");
+        }
+        if (!closed) {
+            closed = true;
+            try {
+                if (!virtual) {
+                    PyLib.releaseGil0(gilState);
+                }
+            } finally {
+                if (gated) {
+                    GilGate.exit();
+                }
+            }
+        }
+    }
+}
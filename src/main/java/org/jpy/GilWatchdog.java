@@ -0,0 +1,300 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.jpy;
+
+import java.lang.management.LockInfo;
+import java.lang.management.ManagementFactory;
+import java.lang.management.MonitorInfo;
+import java.lang.management.ThreadInfo;
+import java.lang.management.ThreadMXBean;
+import java.util.ArrayList;
+import java.util.HashMap;
+import java.util.HashSet;
+import java.util.List;
+import java.util.Map;
+import java.util.Set;
+import java.util.concurrent.TimeUnit;
+import java.util.function.Consumer;
+
+/**
+ * Detects Java threads waiting too long for the Python GIL, and dead-locks between the GIL and Java locks.
+ * <p>
+ * While the watchdog runs, the native code tracks which Java threads are waiting for the GIL and which thread holds
+ * the GIL while running Java code, i.e. a Python thread calling a Java method, or a Java thread within a
+ * {@link GilScope}. Tracking only costs a few memory writes per GIL acquisition, so the watchdog can be left on
+ * in production. The watchdog thread polls that state and, once a thread has waited longer than the timeout,
+ * reports the waiting threads, the GIL holder, the stacks of all Java threads and the stacks of all Python threads.
+ * If the GIL holder is blocked on a Java lock that is (directly or indirectly) owned by a thread waiting for the GIL,
+ * the report names the dead-lock cycle.
+ * <p>
+ * Only waits of Java threads entering Python through {@code PyLib} are tracked, not the GIL switches among Python
+ * threads. Virtual threads are tracked, but have no ID the watchdog could resolve.
+ *
+ * @see PyLib#startGilWatchdog(long, Consumer)
+ * @since 0.10
+ */
+final class GilWatchdog implements Runnable {
+
+    private static GilWatchdog instance;
+
+    private final long timeoutNanos;
+    private final long periodMillis;
+    private final Consumer<String> reporter;
+    private final Thread thread;
+    private volatile boolean stopped;
+
+    // The ongoing waits by slot
+    private Map<Long, Wait> waits = new HashMap<>();
+    private long holderChanges = -1;
+    private long holderSince;
+
+    /**
+     * A wait of a thread for the GIL, identified by the thread's slot and its number of waits.
+     */
+    private static final class Wait {
+        private final long threadId;
+        private final long count;
+        private final long since;
+        private boolean reported;
+
+        private Wait(long threadId, long count, long since) {
+            this.threadId = threadId;
+            this.count = count;
+            this.since = since;
+        }
+    }
+
+    static synchronized void start(long timeoutMillis, Consumer<String> reporter) {
+        if (timeoutMillis <= 0) {
+            throw new IllegalArgumentException("timeoutMillis must be positive");
+        }
+        stop();
+        if (!PyLib.setGilWatchdogEnabled(true)) {
+            throw new RuntimeException("failed to enable the GIL watchdog");
+        }
+        instance = new GilWatchdog(timeoutMillis, reporter != null ? reporter : System.err::println);
+        instance.thread.start();
+    }
+
+    static synchronized void stop() {
+        if (instance != null) {
+            PyLib.setGilWatchdogEnabled(false);
+            instance.stopped = true;
+            instance.thread.interrupt();
+            instance = null;
+        }
+    }
+
+    static synchronized boolean isRunning() {
+        return instance != null;
+    }
+
+    private GilWatchdog(long timeoutMillis, Consumer<String> reporter) {
+        this.timeoutNanos = TimeUnit.MILLISECONDS.toNanos(timeoutMillis);
+        this.periodMillis = Math.max(10, Math.min(1000, timeoutMillis / 4));
+        this.reporter = reporter;
+        this.thread = new Thread(this, "jpy-gil-watchdog");
+        this.thread.setDaemon(true);
+    }
+
+    @Override
+    public void run() {
+        while (!stopped) {
+            try {
+                Thread.sleep(periodMillis);
+                check();
+            } catch (InterruptedException e) {
+                // Stopped
+            } catch (Throwable t) {
+                // Keep watching, e.g. if the reporter has failed
+                if (PyLib.DEBUG) t.printStackTrace();
+            }
+        }
+    }
+
+    private void check() {
+        long[] state = PyLib.getGilWatchdogState();
+        long now = System.nanoTime();
+
+        long holderId = state[0];
+        if (state[1] != holderChanges) {
+            holderChanges = state[1];
+            holderSince = now;
+        }
+        if (state[2] != 0) {
+            releaseTerminatedThreads(state);
+        }
+
+        Map<Long, Wait> ongoingWaits = new HashMap<>();
+        List<Wait> stalledWaits = new ArrayList<>();
+        for (int i = 3; i + 2 < state.length; i += 3) {
+            long slot = state[i];
+            long threadId = state[i + 1];
+            long count = state[i + 2];
+            if (count % 2 == 0) {
+                continue;
+            }
+            Wait wait = waits.get(slot);
+            if (wait == null || wait.threadId != threadId || wait.count != count) {
+                wait = new Wait(threadId, count, now);
+            }
+            ongoingWaits.put(slot, wait);
+            if (!wait.reported && now - wait.since >= timeoutNanos) {
+                wait.reported = true;
+                stalledWaits.add(wait);
+            }
+        }
+        waits = ongoingWaits;
+
+        if (!stalledWaits.isEmpty()) {
+            reporter.accept(createReport(stalledWaits, ongoingWaits.values(), holderId, now - holderSince, now));
+        }
+    }
+
+    private String createReport(List<Wait> stalledWaits, Iterable<Wait> allWaits, long holderId, long holderNanos, long now) {
+        ThreadMXBean threadMXBean = ManagementFactory.getThreadMXBean();
+        Set<Long> waitingThreadIds = new HashSet<>();
+        for (Wait wait : allWaits) {
+            waitingThreadIds.add(wait.threadId);
+        }
+
+        StringBuilder report = new StringBuilder();
+        String cycle = findCycle(threadMXBean, holderId, waitingThreadIds);
+        if (cycle != null) {
+            report.append("jpy: Dead-lock between the Python GIL and Java locks detected:\n").append(cycle);
+        } else {
+            report.append("jpy: Java thread(s) waiting for the Python GIL longer than ")
+                    .append(TimeUnit.NANOSECONDS.toMillis(timeoutNanos)).append(" ms\n");
+        }
+
+        report.append("Threads waiting for the GIL:\n");
+        for (Wait wait : stalledWaits) {
+            report.append("  ").append(describeThread(threadMXBean, wait.threadId))
+                    .append(" for ").append(TimeUnit.NANOSECONDS.toMillis(now - wait.since)).append(" ms\n");
+        }
+        report.append("GIL holder: ");
+        if (holderId != 0) {
+            report.append(describeThread(threadMXBean, holderId)).append(", running Java code for ")
+                    .append(TimeUnit.NANOSECONDS.toMillis(holderNanos)).append(" ms\n");
+        } else {
+            report.append("no thread running Java code, i.e. a thread running Python code\n");
+        }
+
+        report.append("Java thread stacks:\n");
+        ThreadInfo[] threadInfos = threadMXBean.dumpAllThreads(threadMXBean.isObjectMonitorUsageSupported(),
+                                                               threadMXBean.isSynchronizerUsageSupported());
+        for (ThreadInfo threadInfo : threadInfos) {
+            appendThreadInfo(report, threadInfo);
+        }
+        report.append("Python thread stacks:\n").append(PyLib.dumpPythonStacks());
+        return report.toString();
+    }
+
+    /**
+     * Follows the owners of the Java locks the GIL holder is blocked on. If it reaches a thread waiting for the GIL,
+     * the threads are dead-locked.
+     *
+     * @return A description of the cycle, or {@code null} if there is none.
+     */
+    private static String findCycle(ThreadMXBean threadMXBean, long holderId, Set<Long> waitingThreadIds) {
+        if (holderId <= 0) {
+            return null;
+        }
+        StringBuilder cycle = new StringBuilder();
+        Set<Long> visitedThreadIds = new HashSet<>();
+        long threadId = holderId;
+        while (visitedThreadIds.add(threadId)) {
+            ThreadInfo threadInfo = threadMXBean.getThreadInfo(threadId);
+            if (threadInfo == null || threadInfo.getLockOwnerId() == -1) {
+                return null;
+            }
+            cycle.append("  ").append(describeThread(threadInfo))
+                    .append(threadId == holderId ? " holds the GIL and" : "")
+                    .append(" waits for ").append(threadInfo.getLockName())
+                    .append(" held by ").append(describeThread(threadMXBean, threadInfo.getLockOwnerId())).append("\n");
+            threadId = threadInfo.getLockOwnerId();
+            if (waitingThreadIds.contains(threadId)) {
+                cycle.append("  ").append(describeThread(threadMXBean, threadId))
+                        .append(" waits for the GIL held by ").append(describeThread(threadMXBean, holderId)).append("\n");
+                return cycle.toString();
+            }
+        }
+        return null;
+    }
+
+    private static String describeThread(ThreadMXBean threadMXBean, long threadId) {
+        if (threadId < 0) {
+            return "a virtual thread";
+        }
+        ThreadInfo threadInfo = threadMXBean.getThreadInfo(threadId);
+        return threadInfo != null ? describeThread(threadInfo) : "thread " + threadId;
+    }
+
+    private static String describeThread(ThreadInfo threadInfo) {
+        return "\"" + threadInfo.getThreadName() + "\" (id " + threadInfo.getThreadId() + ")";
+    }
+
+    /**
+     * Like {@link ThreadInfo#toString()}, but without its limit of 8 frames.
+     */
+    private static void appendThreadInfo(StringBuilder report, ThreadInfo threadInfo) {
+        report.append("  ").append(describeThread(threadInfo)).append(" ").append(threadInfo.getThreadState());
+        if (threadInfo.getLockName() != null) {
+            report.append(" on ").append(threadInfo.getLockName());
+        }
+        if (threadInfo.getLockOwnerName() != null) {
+            report.append(" owned by \"").append(threadInfo.getLockOwnerName()).append("\" (id ").append(threadInfo.getLockOwnerId()).append(")");
+        }
+        if (threadInfo.isInNative()) {
+            report.append(" (in native)");
+        }
+        report.append("\n");
+        StackTraceElement[] stackTrace = threadInfo.getStackTrace();
+        MonitorInfo[] lockedMonitors = threadInfo.getLockedMonitors();
+        for (int i = 0; i < stackTrace.length; i++) {
+            report.append("\tat ").append(stackTrace[i]).append("\n");
+            for (MonitorInfo lockedMonitor : lockedMonitors) {
+                if (lockedMonitor.getLockedStackDepth() == i) {
+                    report.append("\t- locked ").append(lockedMonitor).append("\n");
+                }
+            }
+        }
+        LockInfo[] lockedSynchronizers = threadInfo.getLockedSynchronizers();
+        for (LockInfo lockedSynchronizer : lockedSynchronizers) {
+            report.append("\t- locked ").append(lockedSynchronizer).append("\n");
+        }
+    }
+
+    /**
+     * Releases the slots of terminated threads, called once all slots are in use.
+     */
+    private static void releaseTerminatedThreads(long[] state) {
+        ThreadMXBean threadMXBean = ManagementFactory.getThreadMXBean();
+        List<Long> terminatedThreadIds = new ArrayList<>();
+        for (int i = 3; i + 2 < state.length; i += 3) {
+            long threadId = state[i + 1];
+            if (threadId > 0 && threadMXBean.getThreadInfo(threadId) == null) {
+                terminatedThreadIds.add(threadId);
+            }
+        }
+        long[] threadIds = new long[terminatedThreadIds.size()];
+        for (int i = 0; i < threadIds.length; i++) {
+            threadIds[i] = terminatedThreadIds.get(i);
+        }
+        PyLib.releaseGilWatchdogThreads(threadIds);
+    }
+}
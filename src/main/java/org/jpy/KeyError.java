@@ -21,8 +21,12 @@ package org.jpy;
 /**
   * Translation of Python KeyErrors so that they can be programmatically detected from Java.
   */
-public class KeyError extends RuntimeException {
+public class KeyError extends PyException {
     KeyError(String message) {
-        super(message);
+        super(message, CONTROL_FLOW_STACK_TRACES);
     }
-}
\ No newline at end of file
+
+    KeyError(long value, long traceback) {
+        super(value, traceback, CONTROL_FLOW_STACK_TRACES);
+    }
+}
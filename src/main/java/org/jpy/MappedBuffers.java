@@ -0,0 +1,104 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.jpy;
+
+import java.io.File;
+import java.io.IOException;
+import java.nio.ByteOrder;
+import java.nio.MappedByteBuffer;
+import java.nio.channels.FileChannel;
+import java.nio.file.StandardOpenOption;
+
+/**
+ * Maps files into memory so that Java and Python can share the very same pages without copying.
+ * <p>
+ * A {@link MappedByteBuffer} returned by this class is a direct buffer. When it is passed to Python,
+ * it supports the Python buffer protocol, so {@code memoryview(buffer)} directly refers to the mapped
+ * memory, and {@code memoryview(buffer).cast('d')} or {@code numpy.frombuffer(buffer, dtype)}
+ * give typed views of it. Changes made on either side are immediately visible on the other.
+ * <p>
+ * The buffers use the native byte order, which is the byte order of Python's typed views.
+ * Typed Java views such as {@code buffer.asDoubleBuffer()} therefore see the same values as Python.
+ * <p>
+ * Writes reach the file at the latest when the mapping is garbage collected. Call {@link #sync(MappedByteBuffer)}
+ * (or {@link MappedByteBuffer#force()}) to write them to the storage device explicitly, e.g. before the next
+ * processing stage opens the file.
+ *
+ * @since 0.10
+ */
+public final class MappedBuffers {
+
+    /**
+     * Maps a whole existing file.
+     *
+     * @param path     The file path.
+     * @param writable If {@code true}, the mapping is writable, otherwise it is read-only.
+     * @return The mapped buffer.
+     * @throws IOException If the file cannot be opened or mapped.
+     */
+    public static MappedByteBuffer map(String path, boolean writable) throws IOException {
+        return map(path, writable, 0L, new File(path).length());
+    }
+
+    /**
+     * Maps a region of a file. If the mapping is writable and the file is shorter than {@code offset + size},
+     * the file is created or extended as required.
+     *
+     * @param path     The file path.
+     * @param writable If {@code true}, the mapping is writable, otherwise it is read-only.
+     * @param offset   The position within the file at which the mapped region starts.
+     * @param size     The size of the mapped region in bytes, at most {@link Integer#MAX_VALUE}.
+     * @return The mapped buffer.
+     * @throws IOException If the file cannot be opened or mapped.
+     */
+    public static MappedByteBuffer map(String path, boolean writable, long offset, long size) throws IOException {
+        if (offset < 0) {
+            throw new IllegalArgumentException("offset must not be negative");
+        }
+        if (size < 0 || size > Integer.MAX_VALUE) {
+            throw new IllegalArgumentException("size must be in the range 0 to " + Integer.MAX_VALUE);
+        }
+        FileChannel channel;
+        if (writable) {
+            channel = FileChannel.open(new File(path).toPath(),
+                                       StandardOpenOption.READ, StandardOpenOption.WRITE, StandardOpenOption.CREATE);
+        } else {
+            channel = FileChannel.open(new File(path).toPath(), StandardOpenOption.READ);
+        }
+        // The mapping stays valid after the channel has been closed
+        try {
+            MappedByteBuffer buffer = channel.map(writable ? FileChannel.MapMode.READ_WRITE : FileChannel.MapMode.READ_ONLY,
+                                                  offset, size);
+            buffer.order(ByteOrder.nativeOrder());
+            return buffer;
+        } finally {
+            channel.close();
+        }
+    }
+
+    /**
+     * Writes all changes made to the mapped buffer, by Java or Python, to the storage device.
+     *
+     * @param buffer The mapped buffer.
+     */
+    public static void sync(MappedByteBuffer buffer) {
+        buffer.force();
+    }
+
+    private MappedBuffers() {
+    }
+}
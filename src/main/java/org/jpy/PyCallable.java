@@ -0,0 +1,344 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.jpy;
+
+import java.util.Arrays;
+import java.util.List;
+import java.util.Objects;
+import java.util.concurrent.CompletableFuture;
+import java.util.concurrent.ConcurrentHashMap;
+import java.util.concurrent.ConcurrentMap;
+
+import static org.jpy.PyLib.assertPythonRuns;
+
+/**
+ * A handle for calling a Python callable object repeatedly from Java.
+ * <p>
+ * The callable is resolved only once, by {@link PyObject#getCallable(String)}. A handle created by
+ * {@link #withParamTypes(Class[])} also resolves the Java parameter types used for converting the arguments
+ * only once, so that each call just converts its arguments and calls the Python object.
+ * Handles for the same parameter types are cached, so {@code withParamTypes()} may also be called on each call.
+ * <pre>
+ *     PyCallable score = PyModule.importModule("scoring").getCallable("score");
+ *     PyCallable scoreTyped = score.withParamTypes(String.class, double[].class);
+ *     for (...) {
+ *         double value = scoreTyped.callAndReturnValue(Double.class, name, values);
+ *     }
+ * </pre>
+ *
+ * @since 0.10
+ */
+public final class PyCallable {
+
+    private final PyObject callable;
+    private final Class<?>[] paramTypes;
+    private final long paramTypesHandle;
+    private final ConcurrentMap<List<Class<?>>, PyCallable> typedCallables;
+
+    PyCallable(PyObject callable, Class<?>[] paramTypes) {
+        this(callable, paramTypes, new ConcurrentHashMap<List<Class<?>>, PyCallable>());
+    }
+
+    private PyCallable(PyObject callable, Class<?>[] paramTypes, ConcurrentMap<List<Class<?>>, PyCallable> typedCallables) {
+        this.callable = callable;
+        this.paramTypes = paramTypes;
+        this.paramTypesHandle = paramTypes != null ? PyLib.resolveParamTypes(paramTypes) : 0L;
+        this.typedCallables = typedCallables;
+        if (paramTypesHandle != 0) {
+            PyObjectCleaner.registerParamTypes(this, paramTypesHandle);
+        }
+    }
+
+    /**
+     * @return The Python callable object.
+     */
+    public PyObject getCallable() {
+        return callable;
+    }
+
+    /**
+     * @return The parameter types used for converting the arguments, or {@code null} if they are derived from the argument values.
+     */
+    public Class<?>[] getParamTypes() {
+        return paramTypes != null ? paramTypes.clone() : null;
+    }
+
+    /**
+     * Gets a handle for the same Python callable whose arguments are converted according to the given parameter types.
+     *
+     * @param paramTypes The parameter types. {@code null} elements mean that the Python type is derived from the argument value.
+     * @return A handle with resolved parameter types.
+     */
+    public PyCallable withParamTypes(Class<?>... paramTypes) {
+        Objects.requireNonNull(paramTypes, "paramTypes must not be null");
+        List<Class<?>> signature = Arrays.asList(paramTypes.clone());
+        PyCallable typedCallable = typedCallables.get(signature);
+        if (typedCallable == null) {
+            assertPythonRuns();
+            typedCallable = new PyCallable(callable, signature.toArray(new Class<?>[0]), typedCallables);
+            PyCallable existingCallable = typedCallables.putIfAbsent(signature, typedCallable);
+            if (existingCallable != null) {
+                typedCallable = existingCallable;
+            }
+        }
+        return typedCallable;
+    }
+
+    /**
+     * Calls the Python callable with the given arguments.
+     * <p>
+     * If a Java value in {@code args} cannot be directly converted into a Python object, a Java wrapper will be created instead.
+     * If the Java value in {@code args} is a wrapped Python object of type {@link PyObject}, it will be unwrapped.
+     *
+     * @param args The arguments for the call.
+     * @return A wrapper for the returned Python object.
+     */
+    public PyObject call(Object... args) {
+        assertPythonRuns();
+        checkArgCount(args);
+        long pointer = PyLib.callObject(callable.getPointer(), args.length, args, paramTypesHandle);
+        return pointer != 0 ? new PyObject(pointer, true) : null;
+    }
+
+    /**
+     * Calls the Python callable with the given arguments asynchronously, without waiting for the GIL.
+     * The call is made by jpy's executor thread, see {@link PyLib#submit(java.util.function.Supplier)}.
+     *
+     * @param args The arguments for the call.
+     * @return A future for the wrapper of the returned Python object.
+     */
+    public CompletableFuture<PyObject> submit(final Object... args) {
+        checkArgCount(args);
+        return PyLib.submit(() -> call(args));
+    }
+
+    /**
+     * Calls the Python callable with the given arguments and converts the returned Python object into a Java
+     * object of the given type.
+     *
+     * @param returnType The type of the returned value.
+     * @param args       The arguments for the call.
+     * @param <T>        The return type name.
+     * @return The returned value as Java object.
+     */
+    public <T> T callAndReturnValue(Class<T> returnType, Object... args) {
+        assertPythonRuns();
+        Objects.requireNonNull(returnType, "returnType must not be null");
+        checkArgCount(args);
+        return PyLib.callObjectAndReturnValue(callable.getPointer(), args.length, args, paramTypesHandle, returnType);
+    }
+
+    /**
+     * Calls the Python callable with {@code double} arguments and returns the result as {@code double}.
+     * <p>
+     * The {@code callDouble()} and {@code callLong()} methods pass primitive values directly to Python and
+     * create no Java objects, neither for the arguments nor for the result. Mixed {@code long}/{@code double}
+     * arguments are supported by the variants taking an argument type signature.
+     * The parameter types of this handle are ignored.
+     *
+     * @return The result of the call converted to {@code double}.
+     */
+    public double callDouble() {
+        assertPythonRuns();
+        return PyLib.callDouble(callable.getPointer(), 0, 0, 0L, 0L, 0L, 0L);
+    }
+
+    /**
+     * @see #callDouble()
+     */
+    public double callDouble(double arg0) {
+        assertPythonRuns();
+        return PyLib.callDouble(callable.getPointer(), 1, 0x1, Double.doubleToRawLongBits(arg0), 0L, 0L, 0L);
+    }
+
+    /**
+     * @see #callDouble()
+     */
+    public double callDouble(double arg0, double arg1) {
+        assertPythonRuns();
+        return PyLib.callDouble(callable.getPointer(), 2, 0x3, Double.doubleToRawLongBits(arg0), Double.doubleToRawLongBits(arg1), 0L, 0L);
+    }
+
+    /**
+     * @see #callDouble()
+     */
+    public double callDouble(double arg0, double arg1, double arg2) {
+        assertPythonRuns();
+        return PyLib.callDouble(callable.getPointer(), 3, 0x7, Double.doubleToRawLongBits(arg0), Double.doubleToRawLongBits(arg1), Double.doubleToRawLongBits(arg2), 0L);
+    }
+
+    /**
+     * @see #callDouble()
+     */
+    public double callDouble(double arg0, double arg1, double arg2, double arg3) {
+        assertPythonRuns();
+        return PyLib.callDouble(callable.getPointer(), 4, 0xf, Double.doubleToRawLongBits(arg0), Double.doubleToRawLongBits(arg1), Double.doubleToRawLongBits(arg2), Double.doubleToRawLongBits(arg3));
+    }
+
+    /**
+     * Calls the Python callable with {@code long} arguments and returns the result as {@code long}.
+     *
+     * @return The result of the call converted to {@code long}.
+     * @see #callDouble()
+     */
+    public long callLong() {
+        assertPythonRuns();
+        return PyLib.callLong(callable.getPointer(), 0, 0, 0L, 0L, 0L, 0L);
+    }
+
+    /**
+     * @see #callLong()
+     */
+    public long callLong(long arg0) {
+        assertPythonRuns();
+        return PyLib.callLong(callable.getPointer(), 1, 0, arg0, 0L, 0L, 0L);
+    }
+
+    /**
+     * @see #callLong()
+     */
+    public long callLong(long arg0, long arg1) {
+        assertPythonRuns();
+        return PyLib.callLong(callable.getPointer(), 2, 0, arg0, arg1, 0L, 0L);
+    }
+
+    /**
+     * @see #callLong()
+     */
+    public long callLong(long arg0, long arg1, long arg2) {
+        assertPythonRuns();
+        return PyLib.callLong(callable.getPointer(), 3, 0, arg0, arg1, arg2, 0L);
+    }
+
+    /**
+     * @see #callLong()
+     */
+    public long callLong(long arg0, long arg1, long arg2, long arg3) {
+        assertPythonRuns();
+        return PyLib.callLong(callable.getPointer(), 4, 0, arg0, arg1, arg2, arg3);
+    }
+
+    /**
+     * Calls the Python callable with mixed primitive arguments and returns the result as {@code double}.
+     * <p>
+     * The {@code argTypes} signature has one character per argument, {@code 'J'} for a {@code long} argument
+     * and {@code 'D'} for a {@code double} argument, which must be passed as {@link #doubleArg(double)}.
+     * For example, {@code callDouble("JD", id, doubleArg(x))} calls {@code f(id, x)}.
+     *
+     * @param argTypes The argument type signature, 1 to 4 characters.
+     * @param arg0     The first argument.
+     * @return The result of the call converted to {@code double}.
+     */
+    public double callDouble(String argTypes, long arg0) {
+        return callDouble(argTypes, arg0, 0L, 0L, 0L);
+    }
+
+    /**
+     * @see #callDouble(String, long)
+     */
+    public double callDouble(String argTypes, long arg0, long arg1) {
+        return callDouble(argTypes, arg0, arg1, 0L, 0L);
+    }
+
+    /**
+     * @see #callDouble(String, long)
+     */
+    public double callDouble(String argTypes, long arg0, long arg1, long arg2) {
+        return callDouble(argTypes, arg0, arg1, arg2, 0L);
+    }
+
+    /**
+     * @see #callDouble(String, long)
+     */
+    public double callDouble(String argTypes, long arg0, long arg1, long arg2, long arg3) {
+        assertPythonRuns();
+        return PyLib.callDouble(callable.getPointer(), argTypes.length(), getDoubleArgs(argTypes), arg0, arg1, arg2, arg3);
+    }
+
+    /**
+     * Calls the Python callable with mixed primitive arguments and returns the result as {@code long}.
+     *
+     * @param argTypes The argument type signature, see {@link #callDouble(String, long)}.
+     * @param arg0     The first argument.
+     * @return The result of the call converted to {@code long}.
+     */
+    public long callLong(String argTypes, long arg0) {
+        return callLong(argTypes, arg0, 0L, 0L, 0L);
+    }
+
+    /**
+     * @see #callLong(String, long)
+     */
+    public long callLong(String argTypes, long arg0, long arg1) {
+        return callLong(argTypes, arg0, arg1, 0L, 0L);
+    }
+
+    /**
+     * @see #callLong(String, long)
+     */
+    public long callLong(String argTypes, long arg0, long arg1, long arg2) {
+        return callLong(argTypes, arg0, arg1, arg2, 0L);
+    }
+
+    /**
+     * @see #callLong(String, long)
+     */
+    public long callLong(String argTypes, long arg0, long arg1, long arg2, long arg3) {
+        assertPythonRuns();
+        return PyLib.callLong(callable.getPointer(), argTypes.length(), getDoubleArgs(argTypes), arg0, arg1, arg2, arg3);
+    }
+
+    /**
+     * Encodes a {@code double} argument for the calls taking an argument type signature.
+     *
+     * @param value The argument value.
+     * @return The encoded argument.
+     * @see #callDouble(String, long)
+     */
+    public static long doubleArg(double value) {
+        return Double.doubleToRawLongBits(value);
+    }
+
+    @Override
+    public String toString() {
+        return "PyCallable[" + callable + (paramTypes != null ? ", " + Arrays.toString(paramTypes) : "") + "]";
+    }
+
+    private static int getDoubleArgs(String argTypes) {
+        int n = argTypes.length();
+        if (n < 1 || n > 4) {
+            throw new IllegalArgumentException("argTypes must have 1 to 4 characters");
+        }
+        int doubleArgs = 0;
+        for (int i = 0; i < n; i++) {
+            char c = argTypes.charAt(i);
+            if (c == 'D') {
+                doubleArgs |= 1 << i;
+            } else if (c != 'J') {
+                throw new IllegalArgumentException("illegal argument type '" + c + "', must be 'J' or 'D'");
+            }
+        }
+        return doubleArgs;
+    }
+
+    private void checkArgCount(Object[] args) {
+        Objects.requireNonNull(args, "args must not be null");
+        if (paramTypes != null && args.length != paramTypes.length) {
+            throw new IllegalArgumentException(String.format("expected %d arguments, but got %d", paramTypes.length, args.length));
+        }
+    }
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.jpy;
+
+import java.util.LinkedHashMap;
+import java.util.Map;
+
+/**
+ * A least-recently-used cache of compiled Python code, used by {@link PyObject#executeCode(String, PyInputMode, Object, Object)}.
+ * <p>
+ * The cache is disabled by default. Its capacity is given by the system property {@code jpy.codeCacheSize}
+ * or by {@link PyObject#setCodeCacheSize(int)}.
+ *
+ * @since 0.10
+ */
+final class PyCodeCache {
+
+    private static final Map<Key, PyObject> CACHE = new LinkedHashMap<Key, PyObject>(16, 0.75f, true) {
+        @Override
+        protected boolean removeEldestEntry(Map.Entry<Key, PyObject> eldest) {
+            return size() > capacity;
+        }
+    };
+
+    private static volatile int capacity = Integer.getInteger("jpy.codeCacheSize", 0);
+
+    static int getCapacity() {
+        return capacity;
+    }
+
+    static void setCapacity(int capacity) {
+        if (capacity < 0) {
+            throw new IllegalArgumentException("capacity must not be negative");
+        }
+        synchronized (CACHE) {
+            PyCodeCache.capacity = capacity;
+            if (capacity == 0) {
+                CACHE.clear();
+            } else {
+                trim();
+            }
+        }
+    }
+
+    /**
+     * @return The compiled code, or {@code null} if the cache is disabled.
+     */
+    static PyObject getCompiled(String code, PyInputMode mode) {
+        if (capacity == 0) {
+            return null;
+        }
+        Key key = new Key(code, mode);
+        PyObject compiled;
+        synchronized (CACHE) {
+            compiled = CACHE.get(key);
+        }
+        if (compiled == null) {
+            // Compile outside of the lock, worst case the same code is compiled twice
+            compiled = PyObject.compile(code, mode);
+            synchronized (CACHE) {
+                CACHE.put(key, compiled);
+            }
+        }
+        return compiled;
+    }
+
+    /**
+     * Called before the interpreter is stopped, because the cached code objects become invalid.
+     */
+    static void clear() {
+        synchronized (CACHE) {
+            CACHE.clear();
+        }
+    }
+
+    private static void trim() {
+        while (CACHE.size() > capacity) {
+            Key eldest = CACHE.keySet().iterator().next();
+            CACHE.remove(eldest);
+        }
+    }
+
+    private static final class Key {
+        private final String code;
+        private final PyInputMode mode;
+        private final int hash;
+
+        Key(String code, PyInputMode mode) {
+            this.code = code;
+            this.mode = mode;
+            this.hash = 31 * code.hashCode() + mode.hashCode();
+        }
+
+        @Override
+        public boolean equals(Object o) {
+            if (this == o) {
+                return true;
+            }
+            if (!(o instanceof Key)) {
+                return false;
+            }
+            Key key = (Key) o;
+            return hash == key.hash && mode == key.mode && code.equals(key.code);
+        }
+
+        @Override
+        public int hashCode() {
+            return hash;
+        }
+    }
+
+    private PyCodeCache() {
+    }
+}
@@ -33,7 +33,7 @@ public class PyDictWrapper implements Map<PyObject, PyObject> {
 
     @Override
     public int size() {
-        return pyObject.callMethod("__len__").getIntValue();
+        return PyLib.getLength(pyObject.getPointer());
     }
 
     @Override
@@ -43,7 +43,7 @@ public class PyDictWrapper implements Map<PyObject, PyObject> {
 
     @Override
     public boolean containsKey(Object key) {
-        return pyObject.callMethod("has_key", key).getBooleanValue();
+        return PyLib.dictContainsKey(pyObject.getPointer(), key);
     }
 
     /**
@@ -55,19 +55,20 @@ public class PyDictWrapper implements Map<PyObject, PyObject> {
 
     @Override
     public boolean containsValue(Object value) {
-        return pyObject.callMethod("values").asList().contains(value);
+        return values().contains(value);
     }
 
     @Override
     public PyObject get(Object key) {
-        return pyObject.callMethod("__getitem__", key);
+        long pointer = PyLib.dictGetItem(pyObject.getPointer(), key);
+        return pointer != 0 ? new PyObject(pointer, true) : null;
     }
 
     /**
       * An extension to the Map interface that allows the use of String keys without generating warnings.
       */
     public PyObject get(String key) {
-        return pyObject.callMethod("__getitem__", key);
+        return get((Object)key);
     }
 
     @Override
@@ -86,6 +87,9 @@ public class PyDictWrapper implements Map<PyObject, PyObject> {
     public PyObject remove(Object key) {
         try {
             PyObject value = get(key);
+            if (value == null) {
+                return null;
+            }
             pyObject.callMethod("__delitem__", key);
             return value;
         } catch (KeyError ke) {
@@ -107,14 +111,55 @@ public class PyDictWrapper implements Map<PyObject, PyObject> {
         pyObject.callMethod("clear");
     }
 
+    /**
+      * Returns a view of the keys, which iterates over the dictionary without copying it.
+      */
     @Override
     public Set<PyObject> keySet() {
-        return new LinkedHashSet<>(pyObject.callMethod("keys").asList());
+        return new AbstractSet<PyObject>() {
+            @Override
+            public int size() {
+                return PyDictWrapper.this.size();
+            }
+
+            @Override
+            public boolean contains(Object o) {
+                return containsKey(o);
+            }
+
+            @Override
+            public Iterator<PyObject> iterator() {
+                return new ItemIterator<PyObject>(1) {
+                    @Override
+                    PyObject item(PyObject key, PyObject value) {
+                        return key;
+                    }
+                };
+            }
+        };
     }
 
+    /**
+      * Returns a view of the values, which iterates over the dictionary without copying it.
+      */
     @Override
     public Collection<PyObject> values() {
-        return pyObject.callMethod("values").asList();
+        return new AbstractCollection<PyObject>() {
+            @Override
+            public int size() {
+                return PyDictWrapper.this.size();
+            }
+
+            @Override
+            public Iterator<PyObject> iterator() {
+                return new ItemIterator<PyObject>(2) {
+                    @Override
+                    PyObject item(PyObject key, PyObject value) {
+                        return value;
+                    }
+                };
+            }
+        };
     }
 
     @Override
@@ -149,6 +194,60 @@ public class PyDictWrapper implements Map<PyObject, PyObject> {
         return new PyDictWrapper(PyLib.copyDict(pyObject.getPointer()));
     }
 
+    /**
+      * Copies all keys and values of this dictionary into a Java map with a single native call.
+      *
+      * @return the keys and values of this dictionary in iteration order.
+      */
+    public Map<PyObject, PyObject> snapshot() {
+        long[] pointers = PyLib.dictGetItems(pyObject.getPointer());
+        Map<PyObject, PyObject> map = new LinkedHashMap<>(pointers.length);
+        for (int i = 0; i < pointers.length; i += 2) {
+            map.put(new PyObject(pointers[i], true), new PyObject(pointers[i + 1], true));
+        }
+        return map;
+    }
+
+    /**
+      * Streams the items of the dictionary using the Python/C API function {@code PyDict_Next()}.
+      * Like in Python, the dictionary must not be modified while iterating.
+      */
+    private abstract class ItemIterator<T> implements Iterator<T> {
+        private final long[] keyValue;
+        private long pos;
+        private PyObject nextKey;
+        private PyObject nextValue;
+
+        ItemIterator(int itemLength) {
+            keyValue = new long[itemLength];
+        }
+
+        abstract T item(PyObject key, PyObject value);
+
+        @Override
+        public boolean hasNext() {
+            if (nextKey == null && pos >= 0) {
+                pos = PyLib.dictNext(pyObject.getPointer(), pos, keyValue);
+                if (pos >= 0) {
+                    nextKey = new PyObject(keyValue[0], true);
+                    nextValue = keyValue.length > 1 ? new PyObject(keyValue[1], true) : null;
+                }
+            }
+            return nextKey != null;
+        }
+
+        @Override
+        public T next() {
+            if (!hasNext()) {
+                throw new NoSuchElementException();
+            }
+            T item = item(nextKey, nextValue);
+            nextKey = null;
+            nextValue = null;
+            return item;
+        }
+    }
+
     private class EntrySet implements Set<Entry<PyObject, PyObject>> {
         @Override
         public int size() {
@@ -167,45 +266,10 @@ public class PyDictWrapper implements Map<PyObject, PyObject> {
 
         @Override
         public Iterator<Entry<PyObject, PyObject>> iterator() {
-            return new Iterator<Entry<PyObject, PyObject>>() {
-                PyModule builtins = PyModule.getBuiltins();
-                PyObject it = pyObject.callMethod("__iter__");
-                PyObject next = prepareNext();
-
-                private PyObject prepareNext() {
-                    try {
-                        return next = builtins.call("next", it);
-                    } catch (StopIteration e) {
-                        return next = null;
-                    }
-                }
-
-                @Override
-                public boolean hasNext() {
-                    return next != null;
-                }
-
+            return new ItemIterator<Entry<PyObject, PyObject>>(2) {
                 @Override
-                public Entry<PyObject, PyObject> next() {
-                    final PyObject oldNext = next;
-                    prepareNext();
-                    return new Entry<PyObject, PyObject>() {
-
-                        @Override
-                        public PyObject getKey() {
-                            return oldNext;
-                        }
-
-                        @Override
-                        public PyObject getValue() {
-                            return get(oldNext);
-                        }
-
-                        @Override
-                        public PyObject setValue(PyObject value) {
-                            throw new UnsupportedOperationException();
-                        }
-                    };
+                Entry<PyObject, PyObject> item(PyObject key, PyObject value) {
+                    return new AbstractMap.SimpleImmutableEntry<>(key, value);
                 }
             };
         }
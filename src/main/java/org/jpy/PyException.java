@@ -0,0 +1,99 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.jpy;
+
+/**
+ * A Python exception raised by a call from Java into Python.
+ * <p>
+ * The exception keeps a reference to the Python exception object and its traceback. The message, which describes
+ * the Python exception, is only formatted once {@link #getMessage()} is called, e.g. by {@link #printStackTrace()},
+ * so exceptions that are caught and discarded stay cheap.
+ * <p>
+ * Python exceptions used for control flow are translated into the subclasses {@link KeyError} and
+ * {@link StopIteration}. Their Java stack traces are not captured if the system property
+ * {@code jpy.controlFlowStackTraces} is {@code false}.
+ *
+ * @since 0.10
+ */
+public class PyException extends RuntimeException {
+
+    static final boolean CONTROL_FLOW_STACK_TRACES = Boolean.parseBoolean(System.getProperty("jpy.controlFlowStackTraces", "true"));
+
+    private static final String NOT_AVAILABLE_MSG = "Error in Python interpreter, no information available";
+
+    private final transient PyObject value;
+    private final transient PyObject traceback;
+    private volatile String message;
+
+    PyException(String message) {
+        this(message, true);
+    }
+
+    PyException(String message, boolean writableStackTrace) {
+        super(message, null, true, writableStackTrace);
+        this.value = null;
+        this.traceback = null;
+    }
+
+    /**
+     * Called from native code.
+     *
+     * @param value     A new reference to the Python exception object, taken over by this exception.
+     * @param traceback A new reference to the traceback taken over by this exception, or 0.
+     */
+    PyException(long value, long traceback) {
+        this(value, traceback, true);
+    }
+
+    PyException(long value, long traceback, boolean writableStackTrace) {
+        super(null, null, true, writableStackTrace);
+        this.value = new PyObject(value, true);
+        this.traceback = traceback != 0 ? new PyObject(traceback, true) : null;
+    }
+
+    /**
+     * @return The Python exception object, or {@code null} if not available.
+     */
+    public PyObject getValue() {
+        return value;
+    }
+
+    /**
+     * @return The Python traceback object, or {@code null} if not available.
+     */
+    public PyObject getTraceback() {
+        return traceback;
+    }
+
+    @Override
+    public String getMessage() {
+        if (value == null) {
+            return super.getMessage();
+        }
+        String message = this.message;
+        if (message == null) {
+            if (PyLib.isPythonRunning() && value.isValid()) {
+                message = PyLib.formatException(value.getPointer(), traceback != null ? traceback.getPointer() : 0);
+            }
+            if (message == null) {
+                message = NOT_AVAILABLE_MSG;
+            }
+            this.message = message;
+        }
+        return message;
+    }
+}
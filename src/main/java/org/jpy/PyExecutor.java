@@ -0,0 +1,142 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.jpy;
+
+import java.util.concurrent.CompletableFuture;
+import java.util.concurrent.ConcurrentLinkedQueue;
+import java.util.concurrent.locks.LockSupport;
+import java.util.function.Supplier;
+
+/**
+ * Runs asynchronous calls into Python on a single background thread.
+ * <p>
+ * Requests are queued by the calling threads without blocking. The executor thread acquires the GIL once and
+ * then runs up to {@link #BATCH_SIZE} queued requests within that {@link GilScope}, so that many small calls
+ * share a single GIL acquisition, and the calling threads never wait for the GIL.
+ * The GIL is released between batches, so that other threads can still call into Python.
+ * <p>
+ * A single thread is sufficient, as all Python code runs under the GIL anyway.
+ *
+ * @see PyLib#submit(Supplier)
+ * @since 0.10
+ */
+final class PyExecutor {
+
+    /**
+     * The maximum number of requests run within a single GIL acquisition.
+     */
+    static final int BATCH_SIZE = 64;
+
+    private static final ConcurrentLinkedQueue<Request<?>> QUEUE = new ConcurrentLinkedQueue<>();
+    private static final Thread THREAD;
+    // True while the executor thread is about to park, tells submitters to unpark it
+    private static volatile boolean waiting;
+
+    static {
+        THREAD = new Thread(new Runnable() {
+            @Override
+            public void run() {
+                runRequests();
+            }
+        }, "jpy-executor");
+        THREAD.setDaemon(true);
+        THREAD.start();
+    }
+
+    /**
+     * A queued call and the future it completes.
+     */
+    private static final class Request<T> {
+        private final Supplier<T> action;
+        private final CompletableFuture<T> future = new CompletableFuture<>();
+
+        private Request(Supplier<T> action) {
+            this.action = action;
+        }
+
+        private void run() {
+            if (future.isDone()) {
+                // Cancelled by the caller meanwhile
+                return;
+            }
+            try {
+                future.complete(action.get());
+            } catch (Throwable t) {
+                future.completeExceptionally(t);
+            }
+        }
+
+        private void fail(Throwable t) {
+            future.completeExceptionally(t);
+        }
+    }
+
+    static <T> CompletableFuture<T> submit(Supplier<T> action) {
+        Request<T> request = new Request<>(action);
+        QUEUE.offer(request);
+        if (waiting) {
+            LockSupport.unpark(THREAD);
+        }
+        return request.future;
+    }
+
+    /**
+     * Called before the interpreter is stopped. Fails all requests not yet started.
+     */
+    static void interpreterStopping() {
+        Request<?> request;
+        while ((request = QUEUE.poll()) != null) {
+            request.fail(new IllegalStateException("Python interpreter stopped"));
+        }
+    }
+
+    private static void runRequests() {
+        while (true) {
+            Request<?> request = QUEUE.poll();
+            if (request == null) {
+                // Check the queue again after announcing to park, a request may have been queued in between
+                waiting = true;
+                if (QUEUE.isEmpty()) {
+                    LockSupport.park(PyExecutor.class);
+                }
+                waiting = false;
+                continue;
+            }
+            try {
+                runBatch(request);
+            } catch (Throwable t) {
+                // Keep the thread alive, e.g. if the interpreter has been stopped meanwhile
+                request.fail(t);
+                if (PyLib.DEBUG) t.printStackTrace();
+            }
+        }
+    }
+
+    private static void runBatch(Request<?> request) {
+        PyLib.assertPythonRuns();
+        try (GilScope ignored = PyLib.acquireGil()) {
+            int count = 0;
+            do {
+                request.run();
+                count++;
+            } while (count < BATCH_SIZE && (request = QUEUE.poll()) != null);
+        }
+    }
+
+    private PyExecutor() {
+    }
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.jpy;
+
+import java.util.concurrent.CompletionException;
+import java.util.concurrent.CompletionStage;
+
+/**
+ * Completes Python asyncio futures awaiting Java {@link CompletionStage}s. Called by the jpy module only.
+ * <p>
+ * When Python code awaits a {@code CompletionStage}, jpy creates an asyncio future and registers a completion
+ * action here. The action passes the result to {@link PyLib#completeFuture(long, Object, Throwable)}, which
+ * schedules completing the future in its event loop, so that no thread ever blocks waiting for the stage.
+ *
+ * @since 0.10
+ */
+final class PyFutures {
+
+    /**
+     * Completes the asyncio future referred to by {@code futureRef} once the given stage is complete.
+     * The future is always completed, also if the completion action can't be registered.
+     *
+     * @param stage     The awaited stage.
+     * @param futureRef A reference to the awaiting asyncio future, released on completion.
+     */
+    static void whenComplete(CompletionStage<?> stage, final long futureRef) {
+        try {
+            stage.whenComplete((value, error) -> PyLib.completeFuture(futureRef, value, unwrap(error)));
+        } catch (Throwable t) {
+            PyLib.completeFuture(futureRef, null, t);
+        }
+    }
+
+    private static Throwable unwrap(Throwable error) {
+        // Dependent stages complete with the original exception wrapped
+        if (error instanceof CompletionException && error.getCause() != null) {
+            return error.getCause();
+        }
+        return error;
+    }
+
+    private PyFutures() {
+    }
+}
@@ -23,6 +23,9 @@ import java.io.File;
 import java.io.FileNotFoundException;
 import java.util.ArrayList;
 import java.util.Map;
+import java.util.concurrent.CompletableFuture;
+import java.util.function.Consumer;
+import java.util.function.Supplier;
 
 import static org.jpy.PyLibConfig.JPY_LIB_KEY;
 import static org.jpy.PyLibConfig.OS;
@@ -56,7 +59,7 @@ import static org.jpy.PyLibConfig.getProperty;
 @SuppressWarnings("WeakerAccess")
 public class PyLib {
 
-    private static final boolean DEBUG = Boolean.getBoolean("jpy.debug");
+    static final boolean DEBUG = Boolean.getBoolean("jpy.debug");
     private static final boolean ON_WINDOWS = System.getProperty("os.name").toLowerCase().contains("windows");
     private static final boolean STOP_IS_NO_OP = Boolean.getBoolean("jpy.stopIsNoOp") || ON_WINDOWS;
     private static String dllFilePath;
@@ -158,6 +161,7 @@ public class PyLib {
         if (!isPythonRunning()) {
             throw new RuntimeException("PyLib not initialized");
         }
+        PyObjectCleaner.releasePending();
     }
 
     /**
@@ -206,6 +210,11 @@ public class PyLib {
         }
 
         startPython0(extraPaths);
+
+        String watchdogTimeout = System.getProperty("jpy.gilWatchdog");
+        if (watchdogTimeout != null && !GilWatchdog.isRunning()) {
+            startGilWatchdog(Long.parseLong(watchdogTimeout.trim()), null);
+        }
     }
 
     static native boolean startPython0(String... paths);
@@ -236,12 +245,133 @@ public class PyLib {
      */
     public static void stopPython() {
         if (!STOP_IS_NO_OP) {
+            PyCodeCache.clear();
+            PyExecutor.interpreterStopping();
+            PyObjectCleaner.interpreterStopping();
             stopPython0();
         }
     }
 
     static native void stopPython0();
 
+    /**
+     * Acquires the Python GIL (global interpreter lock) for the current thread until the returned scope is closed.
+     * All {@code PyLib} calls made by the current thread within the scope skip acquiring the GIL.
+     *
+     * @return The scope, which must be closed by the current thread.
+     * @see GilScope
+     * @since 0.10
+     */
+    public static GilScope acquireGil() {
+        assertPythonRuns();
+        return new GilScope();
+    }
+
+    /**
+     * Runs the given action while holding the Python GIL.
+     *
+     * @param action The action, usually a sequence of calls into Python.
+     * @param <T>    The result type name.
+     * @return The result of the action.
+     * @see #acquireGil()
+     * @since 0.10
+     */
+    public static <T> T withGil(Supplier<T> action) {
+        try (GilScope ignored = acquireGil()) {
+            return action.get();
+        }
+    }
+
+    /**
+     * Runs the given action while holding the Python GIL.
+     *
+     * @param action The action, usually a sequence of calls into Python.
+     * @see #acquireGil()
+     * @since 0.10
+     */
+    public static void withGil(Runnable action) {
+        try (GilScope ignored = acquireGil()) {
+            action.run();
+        }
+    }
+
+    /**
+     * Runs the given action asynchronously on jpy's executor thread, which holds the Python GIL.
+     * <p>
+     * The calling thread doesn't wait for the GIL. The executor thread runs queued actions in batches, each batch
+     * within a single GIL acquisition, so submitting many small calls is cheaper than making them from many threads.
+     * Actions run one after the other: an action must not wait for another submitted action, as this will dead-lock.
+     *
+     * @param action The action, usually a sequence of calls into Python.
+     * @param <T>    The result type name.
+     * @return A future completed with the result of the action, or exceptionally with the exception it has thrown.
+     * @see #withGil(Supplier)
+     * @since 0.10
+     */
+    public static <T> CompletableFuture<T> submit(Supplier<T> action) {
+        assertPythonRuns();
+        return PyExecutor.submit(action);
+    }
+
+    /**
+     * @return {@code true} if the current thread holds the Python GIL.
+     * @since 0.10
+     */
+    static native boolean hasGil();
+
+    /**
+     * Starts a watchdog that reports Java threads waiting longer than the given timeout for the Python GIL,
+     * including dead-locks between the GIL and Java locks, e.g. a Python thread calling a {@code synchronized} Java
+     * method while the lock's owner waits for the GIL. A report contains the stacks of all Java and Python threads.
+     * <p>
+     * The watchdog is cheap enough to be left on in production. It is started by {@link #startPython(String...)}
+     * if the system property {@code jpy.gilWatchdog} is set to the timeout in milliseconds.
+     *
+     * @param timeoutMillis The time a thread may wait for the GIL before it is reported.
+     * @param reporter      Receives the reports, if {@code null} they are printed to {@code System.err}.
+     * @since 0.10
+     */
+    public static void startGilWatchdog(long timeoutMillis, Consumer<String> reporter) {
+        GilWatchdog.start(timeoutMillis, reporter);
+    }
+
+    /**
+     * Stops the watchdog started by {@link #startGilWatchdog(long, Consumer)}, if any.
+     *
+     * @since 0.10
+     */
+    public static void stopGilWatchdog() {
+        GilWatchdog.stop();
+    }
+
+    static native boolean setGilWatchdogEnabled(boolean enabled);
+
+    static native long[] getGilWatchdogState();
+
+    static native void releaseGilWatchdogThreads(long[] threadIds);
+
+    /**
+     * Doesn't acquire the GIL. If the stacks cannot be dumped without it, they are written to stderr
+     * by the main thread once it holds the GIL.
+     *
+     * @return The stacks of all Python threads, or a note where they are written to.
+     */
+    static native String dumpPythonStacks();
+
+    static native long acquireGil0();
+
+    static native void releaseGil0(long gilState);
+
+    /**
+     * Completes the Python asyncio future awaiting a Java {@link java.util.concurrent.CompletionStage}.
+     *
+     * @param futureRef A reference to the asyncio future and its event loop, released by this call.
+     * @param value     The result value, if {@code error} is {@code null}.
+     * @param error     The exception the stage completed with, or {@code null}.
+     * @see PyFutures
+     */
+    static native void completeFuture(long futureRef, Object value, Throwable error);
+
     @Deprecated
     public static native int execScript(String script);
 
@@ -250,6 +380,19 @@ public class PyLib {
     static native long executeScript
             (String file, int start, Object globals, Object locals) throws FileNotFoundException;
 
+    /**
+     * @return A Python code object (always a new reference).
+     */
+    static native long compileCode(String code, int start);
+
+    /**
+     * Executes a Python code object returned by {@link #compileCode(String, int)}.
+     * The {@code globals} and {@code locals} are handled like by {@link #executeCode(String, int, Object, Object)}.
+     *
+     * @return The result of the execution (always a new reference).
+     */
+    static native long executeCompiledCode(long code, Object globals, Object locals);
+
     public static native PyObject getMainGlobals();
 
     static native PyObject copyDict(long pyPointer);
@@ -258,6 +401,23 @@ public class PyLib {
 
     static native void decRef(long pointer);
 
+    /**
+     * Decrements the reference counts of multiple Python objects while acquiring the GIL only once.
+     *
+     * @param pointers The Python objects.
+     * @param count    The number of Python objects given by {@code pointers}.
+     */
+    static native void decRefs(long[] pointers, int count);
+
+    /**
+     * Formats the message of a {@link PyException}.
+     *
+     * @param value     The Python exception object.
+     * @param traceback The Python traceback object, or 0.
+     * @return The message, or {@code null} if no information is available.
+     */
+    static native String formatException(long value, long traceback);
+
     static native int getIntValue(long pointer);
 
     static native boolean getBooleanValue(long pointer);
@@ -281,6 +441,49 @@ public class PyLib {
 
     static native long getType(long pointer);
 
+    /**
+     * @return The result of {@code len()} of the given Python object.
+     */
+    static native int getLength(long pointer);
+
+    /**
+     * @return The item of the Python list at the given index (always a new reference).
+     * @throws IndexOutOfBoundsException If the index is out of range.
+     */
+    static native long listGetItem(long pointer, int index);
+
+    /**
+     * @return The {@code count} items of the Python list starting at the given index (always new references).
+     * @throws IndexOutOfBoundsException If the range is out of bounds.
+     */
+    static native long[] listGetItems(long pointer, int index, int count);
+
+    /**
+     * @return The value of the Python dictionary for the given key (always a new reference), or 0 if the key is missing.
+     * @throws PyException If the lookup fails, e.g. if the key is unhashable.
+     */
+    static native long dictGetItem(long pointer, Object key);
+
+    static native boolean dictContainsKey(long pointer, Object key);
+
+    /**
+     * Gets the next item of a Python dictionary, like the Python/C API function {@code PyDict_Next()}.
+     * The dictionary must not be modified while iterating.
+     *
+     * @param pointer  The Python dictionary.
+     * @param pos      The position, which is 0 for the first item and the return value of the previous call otherwise.
+     * @param keyValue Receives the key and the value of the item (always new references).
+     *                 If it has only one element, it just receives the key.
+     * @return The position of the next item, or -1 if there are no more items.
+     */
+    static native long dictNext(long pointer, long pos, long[] keyValue);
+
+    /**
+     * @return All keys and values of the Python dictionary, alternating, as an array of twice the dictionary's size
+     * (always new references).
+     */
+    static native long[] dictGetItems(long pointer);
+
     static native String str(long pointer);
 
     static native String repr(long pointer);
@@ -395,6 +598,79 @@ public class PyLib {
                                            Class<?>[] paramTypes,
                                            Class<T> returnType);
 
+    /**
+     * Resolves the given parameter types once, so that subsequent calls through
+     * {@link #callObject(long, int, Object[], long)} don't need to look them up again.
+     *
+     * @param paramTypes The parameter types. {@code null} elements mean that the Python type is derived from the argument value.
+     * @return A handle for the resolved parameter types, which must be released by {@link #releaseParamTypes(long)}.
+     */
+    static native long resolveParamTypes(Class<?>[] paramTypes);
+
+    /**
+     * Releases parameter types resolved by {@link #resolveParamTypes(Class[])}.
+     *
+     * @param paramTypesHandle The handle returned by {@link #resolveParamTypes(Class[])}.
+     */
+    static native void releaseParamTypes(long paramTypesHandle);
+
+    /**
+     * Calls a Python callable object and returns the resulting Python object.
+     * <p>
+     * Unlike {@link #callAndReturnObject(long, boolean, String, int, Object[], Class[])}, the callable is
+     * not looked up by name and the parameter types have already been resolved.
+     *
+     * @param pointer          Identifies the Python callable.
+     * @param argCount         The argument count (length of the following {@code args} array).
+     * @param args             The arguments.
+     * @param paramTypesHandle A handle returned by {@link #resolveParamTypes(Class[])} for {@code argCount} parameters, or 0.
+     * @return The resulting Python object (always a new reference).
+     */
+    static native long callObject(long pointer,
+                                  int argCount,
+                                  Object[] args,
+                                  long paramTypesHandle);
+
+    /**
+     * Calls a Python callable object and returns a Java Object converted according to the given return type.
+     *
+     * @param pointer          Identifies the Python callable.
+     * @param argCount         The argument count (length of the following {@code args} array).
+     * @param args             The arguments.
+     * @param paramTypesHandle A handle returned by {@link #resolveParamTypes(Class[])} for {@code argCount} parameters, or 0.
+     * @param returnType       Optional return type.
+     * @return The converted return value.
+     */
+    static native <T> T callObjectAndReturnValue(long pointer,
+                                                 int argCount,
+                                                 Object[] args,
+                                                 long paramTypesHandle,
+                                                 Class<T> returnType);
+
+    /**
+     * Calls a Python callable object with up to 4 primitive arguments and returns the result as {@code double}.
+     * No Java objects are created for the arguments or the result.
+     *
+     * @param pointer    Identifies the Python callable.
+     * @param argCount   The argument count, 0 to 4.
+     * @param doubleArgs Bit {@code i} is set if argument {@code i} is a {@code double} given by
+     *                   {@link Double#doubleToRawLongBits(double)}, otherwise it is a {@code long}.
+     * @param arg0       The first argument, ignored if {@code argCount < 1}.
+     * @param arg1       The second argument, ignored if {@code argCount < 2}.
+     * @param arg2       The third argument, ignored if {@code argCount < 3}.
+     * @param arg3       The fourth argument, ignored if {@code argCount < 4}.
+     * @return The Python result converted to {@code double}.
+     */
+    static native double callDouble(long pointer, int argCount, int doubleArgs, long arg0, long arg1, long arg2, long arg3);
+
+    /**
+     * Calls a Python callable object with up to 4 primitive arguments and returns the result as {@code long}.
+     * No Java objects are created for the arguments or the result.
+     *
+     * @see #callDouble(long, int, int, long, long, long, long)
+     */
+    static native long callLong(long pointer, int argCount, int doubleArgs, long arg0, long arg1, long arg2, long arg3);
+
     private static void loadLib() {
         if (dllLoaded || dllProblem != null) {
             return;
@@ -32,7 +32,7 @@ class PyListWrapper implements List<PyObject> {
 
     @Override
     public int size() {
-        return pyObject.callMethod("__len__").getIntValue();
+        return PyLib.getLength(pyObject.getPointer());
     }
 
     @Override
@@ -70,27 +70,18 @@ class PyListWrapper implements List<PyObject> {
 
     @Override
     public PyObject[] toArray() {
-        int size = size();
-
-        PyObject [] result = new PyObject[size];
-        for (int ii = 0; ii < size; ++ii) {
-            result[ii] = get(ii);
-        }
-
-        return result;
+        return getItems(0, size());
     }
 
     @Override
     public <T> T[] toArray(T[] a) {
-        int size = size();
+        PyObject[] items = toArray();
+        int size = items.length;
 
         if (a.length < size) {
             a = Arrays.copyOf(a, size);
         }
-        for (int ii = 0; ii < size; ++ii) {
-            //noinspection unchecked
-            a[ii] = (T)get(ii);
-        }
+        System.arraycopy(items, 0, a, 0, size);
         if (a.length > size) {
             a[size] = null;
         }
@@ -150,7 +141,23 @@ class PyListWrapper implements List<PyObject> {
 
     @Override
     public PyObject get(int index) {
-        return pyObject.callMethod("__getitem__", index);
+        return new PyObject(PyLib.listGetItem(pyObject.getPointer(), index), true);
+    }
+
+    /**
+     * Gets a snapshot of a range of items with a single native call.
+     *
+     * @param index The index of the first item.
+     * @param count The number of items.
+     * @return The items.
+     */
+    PyObject[] getItems(int index, int count) {
+        long[] pointers = PyLib.listGetItems(pyObject.getPointer(), index, count);
+        PyObject[] items = new PyObject[pointers.length];
+        for (int ii = 0; ii < pointers.length; ++ii) {
+            items[ii] = new PyObject(pointers[ii], true);
+        }
+        return items;
     }
 
     @Override
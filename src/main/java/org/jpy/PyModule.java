@@ -130,4 +130,20 @@ public class PyModule extends PyObject {
         Objects.requireNonNull(type, "type must not be null");
         return (T) createProxy(PyLib.CallableKind.FUNCTION, type);
     }
+
+    /**
+     * Create a Java proxy instance of this Python module like {@link #createProxy(Class)}, whose functions are
+     * invoked by jpy's executor thread, see {@link PyObject#createDispatchedProxy(Class)}.
+     *
+     * @param type The interface's type.
+     * @param <T>  The interface name.
+     * @return A (proxy) instance implementing the given interface.
+     * @since 0.10
+     */
+    @Override
+    public <T> T createDispatchedProxy(Class<T> type) {
+        assertPythonRuns();
+        Objects.requireNonNull(type, "type must not be null");
+        return (T) createDispatchedProxy(PyLib.CallableKind.FUNCTION, type);
+    }
 }
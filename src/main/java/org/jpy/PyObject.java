@@ -24,6 +24,7 @@ import java.lang.reflect.Proxy;
 import java.util.List;
 import java.io.FileNotFoundException;
 import java.util.Objects;
+import java.util.concurrent.CompletableFuture;
 
 import static org.jpy.PyLib.assertPythonRuns;
 
@@ -33,19 +34,36 @@ import static org.jpy.PyLib.assertPythonRuns;
  * @author Norman Fomferra
  * @since 0.7
  */
-public class PyObject {
+public class PyObject implements AutoCloseable {
 
     /**
      * The value of the Python/C API {@code PyObject*} which this class represents.
      */
     private final long pointer;
 
+    /**
+     * Releases the Python object, either by {@link #close()} or once this object is unreachable.
+     */
+    private final PyObjectCleaner.Ref ref;
+
     PyObject(long pointer) {
+        this(pointer, false);
+    }
+
+    /**
+     * @param pointer     The Python object.
+     * @param newRefTaken If {@code true}, {@code pointer} is a new reference, which is taken over by this object.
+     *                    Otherwise, the reference count is incremented.
+     */
+    PyObject(long pointer, boolean newRefTaken) {
         if (pointer == 0) {
             throw new IllegalArgumentException("pointer == 0");
         }
-        PyLib.incRef(pointer);
+        if (!newRefTaken) {
+            PyLib.incRef(pointer);
+        }
         this.pointer = pointer;
+        this.ref = PyObjectCleaner.register(this, pointer);
     }
 
     /**
@@ -85,9 +103,60 @@ public class PyObject {
     public static PyObject executeCode(String code, PyInputMode mode, Object globals, Object locals) {
         Objects.requireNonNull(code, "code must not be null");
         Objects.requireNonNull(mode, "mode must not be null");
+        PyObject compiledCode = PyCodeCache.getCompiled(code, mode);
+        if (compiledCode != null) {
+            return executeCompiled(compiledCode, globals, locals);
+        }
         return new PyObject(PyLib.executeCode(code, mode.value(), globals, locals));
     }
 
+    /**
+     * Compiles Python source code into a Python code object, which can be executed repeatedly
+     * by {@link #executeCompiled(PyObject, Object, Object)} without parsing the source code again.
+     *
+     * @param code The Python source code.
+     * @param mode The execution mode.
+     * @return The Python code object.
+     * @since 0.10
+     */
+    public static PyObject compile(String code, PyInputMode mode) {
+        assertPythonRuns();
+        Objects.requireNonNull(code, "code must not be null");
+        Objects.requireNonNull(mode, "mode must not be null");
+        return new PyObject(PyLib.compileCode(code, mode.value()), true);
+    }
+
+    /**
+     * Executes a Python code object returned by {@link #compile(String, PyInputMode)} in the context specified
+     * by the {@code globals} and {@code locals} maps, which are handled like by
+     * {@link #executeCode(String, PyInputMode, Object, Object)}.
+     *
+     * @param compiledCode The Python code object.
+     * @param globals      The global variables to be set, or {@code null}.
+     * @param locals       The locals variables to be set, or {@code null}.
+     * @return The result of executing the code as a Python object.
+     * @throws PyException if {@code compiledCode} is not a Python code object (a {@code TypeError}),
+     *                     or if executing the code raises a Python exception.
+     * @since 0.10
+     */
+    public static PyObject executeCompiled(PyObject compiledCode, Object globals, Object locals) {
+        assertPythonRuns();
+        Objects.requireNonNull(compiledCode, "compiledCode must not be null");
+        return new PyObject(PyLib.executeCompiledCode(compiledCode.getPointer(), globals, locals), true);
+    }
+
+    /**
+     * Sets the capacity of the cache of compiled code used by {@link #executeCode(String, PyInputMode, Object, Object)}.
+     * If enabled, the same source code is only compiled once, as long as it is among the {@code size} most recently
+     * executed ones. The initial capacity is given by the system property {@code jpy.codeCacheSize}, and is 0 by default.
+     *
+     * @param size The maximum number of cached code objects, 0 disables the cache.
+     * @since 0.10
+     */
+    public static void setCodeCacheSize(int size) {
+        PyCodeCache.setCapacity(size);
+    }
+
 
     /**
      * Executes Python source script in the context specified by the {@code globals} and {@code locals} maps.
@@ -110,23 +179,34 @@ public class PyObject {
 
     /**
      * Decrements the reference count of the Python object which this class represents.
+     * This object must not be used anymore afterwards, {@link #getPointer()} and hence all other methods
+     * accessing the Python object throw an {@code IllegalStateException}. Calling this method more than once has no effect.
+     * <p>
+     * Calling this method is optional: otherwise the reference count is decremented in a batch
+     * with others once this object has become unreachable.
      *
-     * @throws Throwable If any error occurs.
+     * @since 0.10
      */
     @Override
-    protected void finalize() throws Throwable {
-        super.finalize();
-        // Don't remove this check. 'pointer == 0' really occurred, don't ask me how!
-        if (pointer == 0) {
-            throw new IllegalStateException("pointer == 0");
-        }
-        PyLib.decRef(getPointer());
+    public void close() {
+        ref.release();
+    }
+
+    /**
+     * @return {@code false} if this object has been closed or the interpreter has been stopped since its creation.
+     */
+    boolean isValid() {
+        return ref.isValid();
     }
 
     /**
      * @return A unique pointer to the wrapped Python object.
+     * @throws IllegalStateException If this object has been closed or the interpreter has been stopped since its creation.
      */
     public final long getPointer() {
+        if (!ref.isValid()) {
+            throw new IllegalStateException("PyObject has been closed or the Python interpreter has been stopped");
+        }
         return pointer;
     }
 
@@ -375,6 +455,20 @@ public class PyObject {
         return pointer != 0 ? new PyObject(pointer) : null;
     }
 
+    /**
+     * Calls the callable Python method with the given name and arguments asynchronously, without waiting for the GIL.
+     * The call is made by jpy's executor thread, see {@link PyLib#submit(java.util.function.Supplier)}.
+     *
+     * @param name A name of a Python attribute that evaluates to a callable object.
+     * @param args The arguments for the method call.
+     * @return A future for the wrapper of the returned Python object.
+     * @since 0.10
+     */
+    public CompletableFuture<PyObject> callMethodAsync(final String name, final Object... args) {
+        Objects.requireNonNull(name, "name must not be null");
+        return PyLib.submit(() -> callMethod(name, args));
+    }
+
     /**
      * Call the callable Python object with the given name and arguments.
      * <p>
@@ -392,6 +486,41 @@ public class PyObject {
         return pointer != 0 ? new PyObject(pointer) : null;
     }
 
+    /**
+     * Looks up the callable Python attribute with the given name once and returns a handle for calling it repeatedly.
+     * <p>
+     * Unlike {@link #call(String, Object...)} and {@link #callMethod(String, Object...)}, calls through the returned
+     * handle don't resolve the attribute again.
+     *
+     * @param name A name of a Python attribute that evaluates to a callable object.
+     * @return A handle for the callable.
+     * @since 0.10
+     */
+    public PyCallable getCallable(String name) {
+        assertPythonRuns();
+        Objects.requireNonNull(name, "name must not be null");
+        PyObject callable = getAttribute(name);
+        if (callable == null || !callable.isCallable()) {
+            throw new IllegalArgumentException("Python attribute '" + name + "' is not callable");
+        }
+        return new PyCallable(callable, null);
+    }
+
+    /**
+     * Returns a handle for calling this Python object repeatedly.
+     *
+     * @return A handle for this callable.
+     * @throws IllegalArgumentException if this Python object is not callable.
+     * @since 0.10
+     */
+    public PyCallable asCallable() {
+        assertPythonRuns();
+        if (!isCallable()) {
+            throw new IllegalArgumentException("Python object is not callable");
+        }
+        return new PyCallable(this, null);
+    }
+
     /**
      * Create a Java proxy instance of this Python object which contains compatible methods to the ones provided in the
      * interface given by the {@code type} parameter.
@@ -422,6 +551,43 @@ public class PyObject {
         return Proxy.newProxyInstance(classLoader, types, invocationHandler);
     }
 
+    /**
+     * Creates a Java proxy instance of this Python object like {@link #createProxy(Class)}, whose methods are
+     * invoked by jpy's executor thread.
+     * <p>
+     * The executor thread runs queued invocations back-to-back within a single GIL acquisition, so that proxies used as
+     * callbacks by many Java threads, e.g. listeners, don't compete for the GIL on each call. Calls remain synchronous:
+     * the calling thread waits for the result. Calls made by threads already holding the GIL are made directly.
+     *
+     * @param type The interface class.
+     * @param <T>  The interface name.
+     * @return A (proxy) instance implementing the given interface.
+     * @see PyLib#submit(java.util.function.Supplier)
+     * @since 0.10
+     */
+    public <T> T createDispatchedProxy(Class<T> type) {
+        assertPythonRuns();
+        //noinspection unchecked
+        Objects.requireNonNull(type, "type must not be null");
+        return (T) createDispatchedProxy(PyLib.CallableKind.METHOD, type);
+    }
+
+    /**
+     * Creates a Java proxy instance of this Python object (or module) like {@link #createProxy(PyLib.CallableKind, Class[])},
+     * whose methods are invoked by jpy's executor thread, see {@link #createDispatchedProxy(Class)}.
+     *
+     * @param callableKind The kind of calls to be made.
+     * @param types        The interface types.
+     * @return A instance implementing the all the given interfaces which serves as a proxy for the given Python object (or module).
+     * @since 0.10
+     */
+    public Object createDispatchedProxy(PyLib.CallableKind callableKind, Class<?>... types) {
+        assertPythonRuns();
+        ClassLoader classLoader = types[0].getClassLoader();
+        InvocationHandler invocationHandler = new PyProxyHandler(this, callableKind, true);
+        return Proxy.newProxyInstance(classLoader, types, invocationHandler);
+    }
+
     /**
      * Gets the python string representation of this object.
      *
@@ -430,7 +596,7 @@ public class PyObject {
      */
     @Override
     public final String toString() {
-	    return PyLib.str(pointer);
+	    return PyLib.str(getPointer());
     }
 
     /**
@@ -440,7 +606,7 @@ public class PyObject {
      * @see #getPointer()
      */
     public final String repr() {
-	    return PyLib.repr(pointer);
+	    return PyLib.repr(getPointer());
     }
 
     /**
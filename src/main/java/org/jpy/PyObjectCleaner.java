@@ -0,0 +1,187 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.jpy;
+
+import java.lang.ref.PhantomReference;
+import java.lang.ref.Reference;
+import java.lang.ref.ReferenceQueue;
+import java.util.Collections;
+import java.util.Set;
+import java.util.concurrent.ConcurrentHashMap;
+import java.util.concurrent.atomic.AtomicBoolean;
+
+/**
+ * Releases the Python objects referenced by unreachable {@link PyObject} instances, and the parameter types
+ * resolved for unreachable {@link PyCallable} instances.
+ * <p>
+ * Each {@code PyObject} registers a phantom reference here. Once the garbage collector has enqueued the references
+ * of unreachable instances, their Python objects are released in batches, each batch by a single native call that
+ * acquires the GIL only once. Batches are released by a background daemon thread, and opportunistically
+ * by the next call of {@link PyLib#assertPythonRuns()}, i.e. the next call into Python.
+ * <p>
+ * This replaces {@code PyObject.finalize()}, which made a native call, and hence a GIL acquisition,
+ * for each single instance from the finalizer thread. Parameter types are rare and released one by one.
+ *
+ * @since 0.10
+ */
+final class PyObjectCleaner {
+
+    /**
+     * The maximum number of Python objects released by a single native call.
+     */
+    static final int BATCH_SIZE = 256;
+
+    private static final ReferenceQueue<Object> QUEUE = new ReferenceQueue<>();
+    // Phantom references must stay strongly reachable until they are enqueued
+    private static final Set<Reference<?>> REFS = Collections.newSetFromMap(new ConcurrentHashMap<Reference<?>, Boolean>());
+    // Incremented whenever the interpreter is stopped, pointers of earlier generations are no longer valid
+    private static volatile int generation;
+
+    static {
+        Thread drainer = new Thread(new Runnable() {
+            @Override
+            public void run() {
+                drainQueue();
+            }
+        }, "jpy-PyObject-cleaner");
+        drainer.setDaemon(true);
+        drainer.start();
+    }
+
+    /**
+     * The phantom reference of a {@code PyObject}, which also releases its Python object.
+     */
+    static final class Ref extends PhantomReference<PyObject> {
+        private final long pointer;
+        private final int generation;
+        private final AtomicBoolean released = new AtomicBoolean();
+
+        private Ref(PyObject referent, long pointer) {
+            super(referent, QUEUE);
+            this.pointer = pointer;
+            this.generation = PyObjectCleaner.generation;
+        }
+
+        /**
+         * Releases the Python object immediately, if not already done. Used by {@link PyObject#close()}.
+         */
+        void release() {
+            if (markReleased()) {
+                PyLib.decRef(pointer);
+            }
+        }
+
+        boolean isValid() {
+            return !released.get() && generation == PyObjectCleaner.generation;
+        }
+
+        private boolean markReleased() {
+            if (!released.compareAndSet(false, true)) {
+                return false;
+            }
+            clear();
+            REFS.remove(this);
+            return generation == PyObjectCleaner.generation;
+        }
+    }
+
+    /**
+     * The phantom reference of a {@code PyCallable}, which also releases its resolved parameter types.
+     */
+    private static final class ParamTypesRef extends PhantomReference<PyCallable> {
+        private final long paramTypesHandle;
+        private final int generation;
+
+        private ParamTypesRef(PyCallable referent, long paramTypesHandle) {
+            super(referent, QUEUE);
+            this.paramTypesHandle = paramTypesHandle;
+            this.generation = PyObjectCleaner.generation;
+        }
+
+        private void release() {
+            REFS.remove(this);
+            if (generation == PyObjectCleaner.generation) {
+                PyLib.releaseParamTypes(paramTypesHandle);
+            }
+        }
+    }
+
+    static Ref register(PyObject pyObject, long pointer) {
+        Ref ref = new Ref(pyObject, pointer);
+        REFS.add(ref);
+        return ref;
+    }
+
+    static void registerParamTypes(PyCallable pyCallable, long paramTypesHandle) {
+        REFS.add(new ParamTypesRef(pyCallable, paramTypesHandle));
+    }
+
+    /**
+     * Releases the Python objects of all {@code PyObject} instances found unreachable so far, without blocking.
+     */
+    static void releasePending() {
+        Reference<?> ref = QUEUE.poll();
+        if (ref != null) {
+            releaseBatches(ref, new long[BATCH_SIZE]);
+        }
+    }
+
+    /**
+     * Called before the interpreter is stopped. Releases pending Python objects while still possible, and
+     * makes sure that the pointers of the remaining {@code PyObject} instances are never released later on.
+     */
+    static void interpreterStopping() {
+        releasePending();
+        generation++;
+    }
+
+    private static void drainQueue() {
+        long[] pointers = new long[BATCH_SIZE];
+        while (true) {
+            try {
+                releaseBatches(QUEUE.remove(), pointers);
+            } catch (InterruptedException e) {
+                return;
+            } catch (Throwable t) {
+                // Keep the thread alive, e.g. if the interpreter has been stopped meanwhile
+                if (PyLib.DEBUG) t.printStackTrace();
+            }
+        }
+    }
+
+    private static void releaseBatches(Reference<?> ref, long[] pointers) {
+        int count = 0;
+        while (ref != null) {
+            if (ref instanceof ParamTypesRef) {
+                ((ParamTypesRef) ref).release();
+            } else if (((Ref) ref).markReleased()) {
+                pointers[count++] = ((Ref) ref).pointer;
+                if (count == pointers.length) {
+                    PyLib.decRefs(pointers, count);
+                    count = 0;
+                }
+            }
+            ref = QUEUE.poll();
+        }
+        if (count > 0) {
+            PyLib.decRefs(pointers, count);
+        }
+    }
+
+    private PyObjectCleaner() {
+    }
+}
@@ -20,6 +20,8 @@ import java.lang.reflect.InvocationHandler;
 import java.lang.reflect.Proxy;
 import java.lang.reflect.Method;
 import java.util.Arrays;
+import java.util.concurrent.CompletableFuture;
+import java.util.concurrent.CompletionException;
 
 import static org.jpy.PyLib.assertPythonRuns;
 
@@ -51,19 +53,44 @@ class PyProxyHandler implements InvocationHandler {
     private final PyObject pyObject;
     
     private final PyLib.CallableKind callableKind;
+
+    private final boolean dispatched;
     
     public PyProxyHandler(PyObject pyObject, PyLib.CallableKind callableKind) {
+        this(pyObject, callableKind, false);
+    }
+
+    /**
+     * @param dispatched If {@code true}, invocations are made by jpy's executor thread, see {@link PyLib#submit(java.util.function.Supplier)}.
+     * @since 0.10
+     */
+    public PyProxyHandler(PyObject pyObject, PyLib.CallableKind callableKind, boolean dispatched) {
         if (pyObject == null) {
             throw new NullPointerException("pyObject");
         }
         this.pyObject = pyObject;
         this.callableKind = callableKind;
+        this.dispatched = dispatched;
     }
     
     @Override
-    public Object invoke(Object proxyObject, Method method, Object[] args) throws Throwable {
+    public Object invoke(final Object proxyObject, final Method method, final Object[] args) throws Throwable {
         assertPythonRuns();
-        
+
+        // A thread already holding the GIL, including the executor thread itself, must not wait for the executor
+        if (!dispatched || PyLib.hasGil()) {
+            return invokePython(proxyObject, method, args);
+        }
+
+        CompletableFuture<Object> result = PyExecutor.submit(() -> invokePython(proxyObject, method, args));
+        try {
+            return result.join();
+        } catch (CompletionException e) {
+            throw e.getCause() != null ? e.getCause() : e;
+        }
+    }
+
+    private Object invokePython(Object proxyObject, Method method, Object[] args) {
         if ((PyLib.Diag.getFlags() & PyLib.Diag.F_METH) != 0) {
             System.out.printf("org.jpy.PyProxyHandler: invoke: %s(%s) on pyObject=%s in thread %s\n", method.getName(),
                     Arrays.toString(args), Long.toHexString(this.pyObject.getPointer()), Thread.currentThread());
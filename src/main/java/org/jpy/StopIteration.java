@@ -21,8 +21,12 @@ package org.jpy;
 /**
  * Translation of Python StopIteration so that they can be programmatically detected from Java.
  */
-public class StopIteration extends RuntimeException {
+public class StopIteration extends PyException {
     StopIteration(String message) {
-        super(message);
+        super(message, CONTROL_FLOW_STACK_TRACES);
+    }
+
+    StopIteration(long value, long traceback) {
+        super(value, traceback, CONTROL_FLOW_STACK_TRACES);
     }
 }
@@ -24,7 +24,7 @@ import java.lang.annotation.Target;
 /**
  * Used to mark method parameters as mutable, that is, an argument's state is expected to be modified by the method.
  * <p>
- * <i>Note: this class is not used yet.</i>
+ * The jpy Python module reads this annotation when it resolves the declaring Java type.
  *
  * @author Norman Fomferra
  */
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.jpy.annotations;
+
+import java.lang.annotation.Annotation;
+import java.lang.reflect.Executable;
+
+/**
+ * Collects the {@link Mutable}, {@link Output} and {@link Return} parameter annotations of a whole set
+ * of methods or constructors in a single call.
+ * <p>
+ * Used by the jpy Python module while it resolves a Java type, so that a class costs one JNI call
+ * instead of one per parameter. Not intended to be used by clients.
+ *
+ * @since 0.10
+ */
+final class ParamAnnotations {
+
+    static final int MUTABLE = 0x01;
+    static final int OUTPUT = 0x02;
+    static final int RETURN = 0x04;
+
+    /**
+     * @param members The methods or constructors of a class.
+     * @return For each member, its parameter flags (a combination of {@link #MUTABLE}, {@link #OUTPUT} and
+     * {@link #RETURN}), or {@code null} if none of its parameters is annotated.
+     * Returns {@code null} if no parameter of any member is annotated.
+     */
+    static int[][] getFlags(Executable[] members) {
+        int[][] flags = null;
+        for (int i = 0; i < members.length; i++) {
+            int[] memberFlags = getFlags(members[i]);
+            if (memberFlags != null) {
+                if (flags == null) {
+                    flags = new int[members.length][];
+                }
+                flags[i] = memberFlags;
+            }
+        }
+        return flags;
+    }
+
+    private static int[] getFlags(Executable member) {
+        Annotation[][] annotations = member.getParameterAnnotations();
+        int[] flags = null;
+        for (int i = 0; i < annotations.length; i++) {
+            for (Annotation annotation : annotations[i]) {
+                int flag = getFlag(annotation);
+                if (flag != 0) {
+                    if (flags == null) {
+                        flags = new int[annotations.length];
+                    }
+                    flags[i] |= flag;
+                }
+            }
+        }
+        return flags;
+    }
+
+    private static int getFlag(Annotation annotation) {
+        Class<? extends Annotation> annotationType = annotation.annotationType();
+        if (annotationType == Mutable.class) {
+            return MUTABLE;
+        } else if (annotationType == Output.class) {
+            return OUTPUT;
+        } else if (annotationType == Return.class) {
+            return RETURN;
+        }
+        return 0;
+    }
+
+    private ParamAnnotations() {
+    }
+}
@@ -24,7 +24,7 @@ import java.lang.annotation.Target;
 /**
  * Used to mark method parameters as return values, that is, an argument may be returned as-is by the method.
  * <p>
- * <i>Note: this class is not used yet.</i>
+ * The jpy Python module reads this annotation when it resolves the declaring Java type.
  *
  * @author Norman Fomferra
  */
@@ -0,0 +1,61 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.jpy.jsr223;
+
+import org.jpy.PyObject;
+
+import javax.script.CompiledScript;
+import javax.script.ScriptContext;
+import javax.script.ScriptEngine;
+import javax.script.ScriptException;
+
+/**
+ * A script compiled once by jpy's {@link ScriptEngineImpl} into a Python code object.
+ * Evaluating it repeatedly doesn't parse the script's source code again.
+ *
+ * @since 0.10
+ */
+class CompiledScriptImpl extends CompiledScript {
+
+    private final ScriptEngineImpl engine;
+    private final PyObject compiledCode;
+
+    CompiledScriptImpl(ScriptEngineImpl engine, PyObject compiledCode) {
+        this.engine = engine;
+        this.compiledCode = compiledCode;
+    }
+
+    /**
+     * Executes the compiled script using the bindings of the given context, just like
+     * {@link ScriptEngineImpl#eval(String, ScriptContext)}.
+     *
+     * @param context A <code>ScriptContext</code> that is used in the same way as
+     *                the <code>ScriptContext</code> passed to the <code>eval</code> methods of <code>ScriptEngine</code>.
+     * @return The value returned by the script execution, if any.
+     * @throws ScriptException      if an error occurs during script execution.
+     * @throws NullPointerException if context is null.
+     */
+    @Override
+    public Object eval(ScriptContext context) throws ScriptException {
+        return engine.evalCompiled(compiledCode, context);
+    }
+
+    @Override
+    public ScriptEngine getEngine() {
+        return engine;
+    }
+}
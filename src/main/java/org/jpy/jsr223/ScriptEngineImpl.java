@@ -16,6 +16,8 @@
 
 package org.jpy.jsr223;
 
+import org.jpy.PyCallable;
+import org.jpy.PyException;
 import org.jpy.PyLib;
 import org.jpy.PyModule;
 import org.jpy.PyObject;
@@ -23,6 +25,8 @@ import org.jpy.PyInputMode;
 
 import javax.script.AbstractScriptEngine;
 import javax.script.Bindings;
+import javax.script.Compilable;
+import javax.script.CompiledScript;
 import javax.script.Invocable;
 import javax.script.ScriptContext;
 import javax.script.ScriptEngineFactory;
@@ -31,6 +35,11 @@ import javax.script.SimpleBindings;
 import java.io.BufferedReader;
 import java.io.File;
 import java.io.Reader;
+import java.util.IdentityHashMap;
+import java.util.Map;
+import java.util.Objects;
+import java.util.concurrent.ConcurrentHashMap;
+import java.util.concurrent.ConcurrentMap;
 import java.util.stream.Collectors;
 
 /**
@@ -39,11 +48,26 @@ import java.util.stream.Collectors;
  * @author Norman Fomferra
  * @since 0.8
  */
-class ScriptEngineImpl extends AbstractScriptEngine implements Invocable {
+class ScriptEngineImpl extends AbstractScriptEngine implements Invocable, Compilable {
 
     public static final String EXTRA_PATHS_KEY = ScriptEngineImpl.class.getName() + ".extraPaths";
 
     private final ScriptEngineFactoryImpl factory;
+    // Functions looked up in bindings by invokeFunction(), per bindings, cleared whenever a script is evaluated
+    private final Map<Bindings, ConcurrentMap<String, CachedFunction>> functions = new IdentityHashMap<>();
+
+    /**
+     * A callable created for a function found in bindings, valid as long as the bindings refer to the same function.
+     */
+    private static final class CachedFunction {
+        private final PyObject source;
+        private final PyCallable callable;
+
+        private CachedFunction(PyObject source, PyCallable callable) {
+            this.source = source;
+            this.callable = callable;
+        }
+    }
 
     ScriptEngineImpl(ScriptEngineFactoryImpl factory) {
         this.factory = factory;
@@ -82,7 +106,7 @@ class ScriptEngineImpl extends AbstractScriptEngine implements Invocable {
      */
     @Override
     public Object eval(Reader reader, ScriptContext context) throws ScriptException {
-        return eval(new BufferedReader(reader).lines().collect(Collectors.joining("\n")), context);
+        return eval(readScript(reader), context);
     }
 
     /**
@@ -107,12 +131,59 @@ class ScriptEngineImpl extends AbstractScriptEngine implements Invocable {
      */
     @Override
     public Object eval(String script, ScriptContext context) throws ScriptException {
+        clearFunctions();
         return PyObject.executeCode(script,
                                     PyInputMode.SCRIPT,
                                     context.getBindings(ScriptContext.GLOBAL_SCOPE),
                                     context.getBindings(ScriptContext.ENGINE_SCOPE));
     }
 
+    /**
+     * Compiles the script for later execution. The returned <code>CompiledScript</code> holds a Python code object,
+     * so that repeated executions don't parse the script again.
+     *
+     * @param script The source of the script, represented as a <code>String</code>.
+     * @return An instance of a subclass of <code>CompiledScript</code> to be executed later using one
+     * of the <code>eval</code> methods of <code>CompiledScript</code>.
+     * @throws ScriptException      if compilation fails.
+     * @throws NullPointerException if the argument is null.
+     */
+    @Override
+    public CompiledScript compile(String script) throws ScriptException {
+        Objects.requireNonNull(script, "script must not be null");
+        try {
+            return new CompiledScriptImpl(this, PyObject.compile(script, PyInputMode.SCRIPT));
+        } catch (PyException e) {
+            throw new ScriptException(e);
+        }
+    }
+
+    /**
+     * Compiles the script (source read from <code>Reader</code>) for later execution.
+     *
+     * @param reader The reader from which the script source is obtained.
+     * @return An instance of a subclass of <code>CompiledScript</code> to be executed later using one
+     * of its <code>eval</code> methods of <code>CompiledScript</code>.
+     * @throws ScriptException      if compilation fails.
+     * @throws NullPointerException if argument is null.
+     */
+    @Override
+    public CompiledScript compile(Reader reader) throws ScriptException {
+        Objects.requireNonNull(reader, "reader must not be null");
+        return compile(readScript(reader));
+    }
+
+    Object evalCompiled(PyObject compiledCode, ScriptContext context) {
+        clearFunctions();
+        return PyObject.executeCompiled(compiledCode,
+                                        context.getBindings(ScriptContext.GLOBAL_SCOPE),
+                                        context.getBindings(ScriptContext.ENGINE_SCOPE));
+    }
+
+    private static String readScript(Reader reader) {
+        return new BufferedReader(reader).lines().collect(Collectors.joining("\n"));
+    }
+
     /**
      * Calls a method on a script object compiled during a previous script execution,
      * which is retained in the state of the <code>ScriptEngine</code>.
@@ -142,6 +213,11 @@ class ScriptEngineImpl extends AbstractScriptEngine implements Invocable {
 
     /**
      * Used to call top-level procedures and functions defined in scripts.
+     * <p>
+     * The function is looked up in the <code>ENGINE_SCOPE</code> bindings of the engine's context, which receive
+     * the top-level definitions of evaluated scripts, then in its <code>GLOBAL_SCOPE</code> bindings, and finally in
+     * the <code>__main__</code> module. Functions found in bindings are cached until the next script is evaluated
+     * or the bindings refer to another function.
      *
      * @param name of the procedure or function to call
      * @param args Arguments to pass to the procedure or function
@@ -152,7 +228,56 @@ class ScriptEngineImpl extends AbstractScriptEngine implements Invocable {
      */
     @Override
     public Object invokeFunction(String name, Object... args) throws ScriptException, NoSuchMethodException {
-        return PyModule.getMain().call(name, args);
+        Objects.requireNonNull(name, "name must not be null");
+        ScriptContext context = getContext();
+        PyCallable function = getFunction(context.getBindings(ScriptContext.ENGINE_SCOPE), name);
+        if (function == null) {
+            function = getFunction(context.getBindings(ScriptContext.GLOBAL_SCOPE), name);
+        }
+        if (function == null) {
+            // Not cached, as any code may redefine the functions of the shared main module
+            PyModule main = PyModule.getMain();
+            if (!main.hasAttribute(name)) {
+                throw new NoSuchMethodException(name);
+            }
+            try {
+                function = main.getCallable(name);
+            } catch (IllegalArgumentException e) {
+                throw new NoSuchMethodException(e.getMessage());
+            }
+        }
+        return function.call(args);
+    }
+
+    private PyCallable getFunction(Bindings bindings, String name) throws NoSuchMethodException {
+        if (bindings == null) {
+            return null;
+        }
+        Object value = bindings.get(name);
+        if (!(value instanceof PyObject)) {
+            return null;
+        }
+        PyObject source = (PyObject) value;
+        ConcurrentMap<String, CachedFunction> bindingsFunctions;
+        synchronized (functions) {
+            bindingsFunctions = functions.computeIfAbsent(bindings, b -> new ConcurrentHashMap<>());
+        }
+        CachedFunction function = bindingsFunctions.get(name);
+        if (function == null || function.source != source) {
+            try {
+                function = new CachedFunction(source, source.asCallable());
+            } catch (IllegalArgumentException e) {
+                throw new NoSuchMethodException(name + ": " + e.getMessage());
+            }
+            bindingsFunctions.put(name, function);
+        }
+        return function.callable;
+    }
+
+    private void clearFunctions() {
+        synchronized (functions) {
+            functions.clear();
+        }
     }
 
     /**
@@ -0,0 +1,221 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.jpy;
+
+import org.junit.After;
+import org.junit.Before;
+import org.junit.Test;
+
+import java.io.FileWriter;
+import java.io.IOException;
+import java.io.PrintWriter;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
+import java.util.Locale;
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.TimeUnit;
+
+import static org.junit.Assert.assertTrue;
+
+/**
+ * Measures how calls from N Java threads into Python scale with the number of threads.
+ * <p>
+ * Not run by default, run it explicitly with {@code mvn test -Dtest=MultiThreadBenchmark}.
+ * Each measurement is written as a JSON object on a line of its own, to standard output or, if given,
+ * appended to the file named by the system property {@code jpy.bench.output}. Further system properties:
+ * <ul>
+ * <li>{@code jpy.bench.threads}: comma-separated thread counts, default {@code 1,2,4,8,16,32,64}</li>
+ * <li>{@code jpy.bench.durationMs}: duration of each measurement, default {@code 2000}</li>
+ * <li>{@code jpy.bench.work}: the argument {@code n} of the Python function {@code sum(range(n))} called, default {@code 100}</li>
+ * </ul>
+ * Modes: {@code call} opens a {@link GilScope} per call, i.e. acquires the GIL as a plain {@code PyLib} call does,
+ * and so also measures the GIL wait time; {@code submit} calls {@link PyCallable#submit(Object...)} and waits
+ * for the result. The Python-to-Java direction is measured by {@code src/test/python/jpy_mt_perf_test.py}.
+ *
+ * @see PyLib#acquireGil()
+ * @see PyLib#submit(java.util.function.Supplier)
+ */
+public class MultiThreadBenchmark {
+
+    private static final int[] THREAD_COUNTS = parseInts(System.getProperty("jpy.bench.threads", "1,2,4,8,16,32,64"));
+    private static final long DURATION_MS = Long.parseLong(System.getProperty("jpy.bench.durationMs", "2000"));
+    private static final int WORK = Integer.parseInt(System.getProperty("jpy.bench.work", "100"));
+
+    private PyCallable work;
+
+    @Before
+    public void setUp() {
+        PyLib.startPython();
+        work = new PyCallable(PyObject.executeCode("lambda n: sum(range(n))", PyInputMode.EXPRESSION), null);
+    }
+
+    @After
+    public void tearDown() {
+        PyLib.stopPython();
+    }
+
+    @Test
+    public void benchmarkJavaToPython() throws Exception {
+        for (String mode : Arrays.asList("call", "submit")) {
+            for (int threadCount : THREAD_COUNTS) {
+                Result result = measure(mode, threadCount);
+                assertTrue(result.ops > 0);
+                report(result);
+            }
+        }
+    }
+
+    private Result measure(final String mode, int threadCount) throws InterruptedException {
+        final CountDownLatch start = new CountDownLatch(1);
+        final long[] deadline = new long[1];
+        final List<Recorder> recorders = new ArrayList<>();
+        List<Thread> threads = new ArrayList<>();
+        for (int i = 0; i < threadCount; i++) {
+            final Recorder recorder = new Recorder();
+            recorders.add(recorder);
+            threads.add(new Thread(() -> {
+                try {
+                    start.await();
+                    while (System.nanoTime() < deadline[0]) {
+                        recorder.record(mode);
+                    }
+                } catch (InterruptedException e) {
+                    Thread.currentThread().interrupt();
+                }
+            }, "jpy-bench-" + i));
+        }
+        for (Thread thread : threads) {
+            thread.start();
+        }
+        long t0 = System.nanoTime();
+        deadline[0] = t0 + TimeUnit.MILLISECONDS.toNanos(DURATION_MS);
+        start.countDown();
+        for (Thread thread : threads) {
+            thread.join();
+        }
+        long t1 = System.nanoTime();
+        return new Result(mode, threadCount, (t1 - t0) / 1e9, recorders);
+    }
+
+    private final class Recorder {
+        long[] latencies = new long[1024];
+        long[] gilWaits = new long[1024];
+        int count;
+
+        void record(String mode) {
+            long t0 = System.nanoTime();
+            long t1;
+            if (mode.equals("call")) {
+                try (GilScope gil = PyLib.acquireGil()) {
+                    t1 = System.nanoTime();
+                    work.callAndReturnValue(Integer.class, WORK);
+                }
+            } else {
+                work.submit(WORK).join();
+                t1 = t0;
+            }
+            long t2 = System.nanoTime();
+            if (count == latencies.length) {
+                latencies = Arrays.copyOf(latencies, 2 * count);
+                gilWaits = Arrays.copyOf(gilWaits, 2 * count);
+            }
+            latencies[count] = t2 - t0;
+            gilWaits[count] = t1 - t0;
+            count++;
+        }
+    }
+
+    private static final class Result {
+        final String mode;
+        final int threadCount;
+        final double seconds;
+        final int ops;
+        final long[] latencies;
+        final long[] gilWaits;
+
+        Result(String mode, int threadCount, double seconds, List<Recorder> recorders) {
+            this.mode = mode;
+            this.threadCount = threadCount;
+            this.seconds = seconds;
+            int ops = 0;
+            for (Recorder recorder : recorders) {
+                ops += recorder.count;
+            }
+            this.ops = ops;
+            this.latencies = new long[ops];
+            this.gilWaits = new long[ops];
+            int offset = 0;
+            for (Recorder recorder : recorders) {
+                System.arraycopy(recorder.latencies, 0, latencies, offset, recorder.count);
+                System.arraycopy(recorder.gilWaits, 0, gilWaits, offset, recorder.count);
+                offset += recorder.count;
+            }
+            Arrays.sort(latencies);
+            Arrays.sort(gilWaits);
+        }
+
+        String toJson() {
+            StringBuilder json = new StringBuilder();
+            json.append(String.format(Locale.ENGLISH,
+                                      "{\"benchmark\": \"java-to-python\", \"mode\": \"%s\", \"threads\": %d, \"ops\": %d, \"seconds\": %.3f, \"ops_per_sec\": %.1f, ",
+                                      mode, threadCount, ops, seconds, ops / seconds));
+            json.append("\"latency_us\": ").append(percentiles(latencies)).append(", ");
+            json.append("\"gil_wait_us\": ").append(mode.equals("call") ? percentiles(gilWaits) : "null").append("}");
+            return json.toString();
+        }
+
+        private static String percentiles(long[] sortedNanos) {
+            long sum = 0;
+            for (long nanos : sortedNanos) {
+                sum += nanos;
+            }
+            return String.format(Locale.ENGLISH, "{\"mean\": %.1f, \"p50\": %.1f, \"p90\": %.1f, \"p99\": %.1f, \"max\": %.1f}",
+                                 sortedNanos.length > 0 ? sum / 1e3 / sortedNanos.length : 0.0,
+                                 percentile(sortedNanos, 0.50), percentile(sortedNanos, 0.90),
+                                 percentile(sortedNanos, 0.99), percentile(sortedNanos, 1.0));
+        }
+
+        private static double percentile(long[] sortedNanos, double p) {
+            if (sortedNanos.length == 0) {
+                return 0.0;
+            }
+            int index = (int) Math.ceil(p * sortedNanos.length) - 1;
+            return sortedNanos[Math.max(0, Math.min(index, sortedNanos.length - 1))] / 1e3;
+        }
+    }
+
+    private static void report(Result result) throws IOException {
+        String output = System.getProperty("jpy.bench.output");
+        if (output == null) {
+            System.out.println(result.toJson());
+        } else {
+            try (PrintWriter writer = new PrintWriter(new FileWriter(output, true))) {
+                writer.println(result.toJson());
+            }
+        }
+    }
+
+    private static int[] parseInts(String values) {
+        String[] parts = values.split(",");
+        int[] ints = new int[parts.length];
+        for (int i = 0; i < parts.length; i++) {
+            ints[i] = Integer.parseInt(parts[i].trim());
+        }
+        return ints;
+    }
+}
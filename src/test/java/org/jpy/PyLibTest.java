@@ -20,7 +20,17 @@ import org.junit.*;
 
 import static org.junit.Assert.*;
 
+import java.util.ArrayList;
+import java.util.List;
 import java.util.Map;
+import java.util.concurrent.CompletableFuture;
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.ExecutionException;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.Future;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.locks.ReentrantLock;
 
 public class PyLibTest {
 
@@ -176,4 +186,189 @@ public class PyLibTest {
         assertFalse(dict.asDict().isEmpty());
     }
 
+    @Test
+    public void testGilScope() throws Exception {
+        final PyModule sys = PyModule.importModule("sys");
+        try (GilScope outer = PyLib.acquireGil()) {
+            assertNotNull(sys.getAttribute("path"));
+            try (GilScope inner = PyLib.acquireGil()) {
+                assertEquals(Integer.valueOf(3), PyLib.withGil(() -> PyObject.executeCode("1 + 2", PyInputMode.EXPRESSION).getIntValue()));
+            }
+            assertNotNull(sys.getAttribute("path"));
+        }
+
+        // The GIL must have been released, otherwise another thread could not call into Python
+        ExecutorService executor = Executors.newSingleThreadExecutor();
+        try {
+            Future<Integer> result = executor.submit(() -> PyObject.executeCode("2 * 3", PyInputMode.EXPRESSION).getIntValue());
+            assertEquals(Integer.valueOf(6), result.get(10, TimeUnit.SECONDS));
+        } finally {
+            executor.shutdown();
+        }
+    }
+
+    @Test
+    public void testGilScopesFromManyThreads() throws Exception {
+        assertFalse(GilGate.isVirtual(Thread.currentThread()));
+
+        // Gate the platform threads of this test, too
+        GilGate.Mode mode = GilGate.mode;
+        GilGate.mode = GilGate.Mode.ALL;
+        ExecutorService executor = Executors.newFixedThreadPool(16);
+        try {
+            List<Future<Integer>> results = new ArrayList<>();
+            for (int i = 0; i < 200; i++) {
+                final int value = i;
+                results.add(executor.submit(() -> PyLib.withGil(() -> PyObject.executeCode(value + " * 2", PyInputMode.EXPRESSION).getIntValue())));
+            }
+            for (int i = 0; i < results.size(); i++) {
+                assertEquals(Integer.valueOf(2 * i), results.get(i).get(10, TimeUnit.SECONDS));
+            }
+        } finally {
+            executor.shutdown();
+            GilGate.mode = mode;
+        }
+    }
+
+    /**
+     * Called by {@link #testGilScopeWithinPythonCall()} from Python, i.e. with the GIL held.
+     */
+    public static int openGilScopeWhileGateIsOwned() throws InterruptedException {
+        Thread gateOwner = new Thread(() -> PyLib.withGil(() -> 0), "jpy-gate-owner");
+        gateOwner.setDaemon(true);
+        gateOwner.start();
+        // The owner of the gate waits for the GIL held by this thread
+        for (int i = 0; i < 1000 && !GilGate.isLocked(); i++) {
+            Thread.sleep(10);
+        }
+        if (!GilGate.isLocked()) {
+            return -1;
+        }
+        return PyLib.withGil(() -> 42);
+    }
+
+    @Test
+    public void testGilScopeWithinPythonCall() throws Exception {
+        GilGate.Mode mode = GilGate.mode;
+        GilGate.mode = GilGate.Mode.ALL;
+        ExecutorService executor = Executors.newSingleThreadExecutor();
+        try {
+            Future<Integer> result = executor.submit(() -> PyObject.executeCode("__import__('jpy').get_type('org.jpy.PyLibTest').openGilScopeWhileGateIsOwned()",
+                                                                                PyInputMode.EXPRESSION).getIntValue());
+            assertEquals(Integer.valueOf(42), result.get(10, TimeUnit.SECONDS));
+        } finally {
+            executor.shutdownNow();
+            GilGate.mode = mode;
+        }
+    }
+
+    @Test
+    public void testInvalidGilGateMode() throws Exception {
+        assertEquals(GilGate.Mode.ALL, GilGate.parseMode(" all "));
+        assertEquals(GilGate.Mode.VIRTUAL, GilGate.parseMode("sometimes"));
+    }
+
+    @Test
+    public void testGilScopeClosedByOtherThread() throws Exception {
+        final GilScope scope = PyLib.acquireGil();
+        try {
+            final Throwable[] error = new Throwable[1];
+            Thread thread = new Thread(() -> {
+                try {
+                    scope.close();
+                } catch (Throwable t) {
+                    error[0] = t;
+                }
+            });
+            thread.start();
+            thread.join();
+            assertTrue(error[0] instanceof IllegalStateException);
+        } finally {
+            scope.close();
+        }
+    }
+
+    /**
+     * Called by {@link #testCallNoGilWithinGilScope()} through jpy.call_nogil().
+     */
+    public static int callBackWithoutGil() {
+        if (PyLib.hasGil()) {
+            return -1;
+        }
+        return PyObject.executeCode("2 + 3", PyInputMode.EXPRESSION).getIntValue();
+    }
+
+    @Test
+    public void testCallNoGilWithinGilScope() throws Exception {
+        try (GilScope ignored = PyLib.acquireGil()) {
+            // The Java method must acquire the GIL again, although the scope is still open
+            PyObject result = PyObject.executeCode("__import__('jpy').call_nogil(__import__('jpy').get_type('org.jpy.PyLibTest').callBackWithoutGil)",
+                                                   PyInputMode.EXPRESSION);
+            assertEquals(5, result.getIntValue());
+            assertTrue(PyLib.hasGil());
+        }
+    }
+
+    @Test
+    public void testGilWatchdogDetectsDeadLock() throws Exception {
+        final CompletableFuture<String> report = new CompletableFuture<>();
+        final ReentrantLock lock = new ReentrantLock();
+        final CountDownLatch locked = new CountDownLatch(1);
+        PyLib.startGilWatchdog(200, report::complete);
+        try {
+            Thread thread;
+            try (GilScope ignored = PyLib.acquireGil()) {
+                // Holds the lock while waiting for the GIL held by this thread
+                thread = new Thread(() -> {
+                    lock.lock();
+                    try {
+                        locked.countDown();
+                        PyObject.executeCode("1 + 1", PyInputMode.EXPRESSION);
+                    } finally {
+                        lock.unlock();
+                    }
+                }, "jpy-watchdog-test");
+                thread.start();
+                assertTrue(locked.await(10, TimeUnit.SECONDS));
+                // Dead-locked until the time-out
+                assertFalse(lock.tryLock(2, TimeUnit.SECONDS));
+            }
+            thread.join(10000);
+            assertFalse(thread.isAlive());
+
+            String text = report.get(10, TimeUnit.SECONDS);
+            assertTrue(text, text.contains("Dead-lock between the Python GIL and Java locks detected"));
+            assertTrue(text, text.contains("\"jpy-watchdog-test\""));
+            assertTrue(text, text.contains("Java thread stacks:"));
+            assertTrue(text, text.contains("Python thread stacks:"));
+        } finally {
+            PyLib.stopGilWatchdog();
+        }
+    }
+
+    @Test
+    public void testSubmit() throws Exception {
+        PyObject builtins = PyModule.importModule("builtins");
+        PyCallable abs = builtins.getCallable("abs");
+
+        CompletableFuture<?>[] futures = new CompletableFuture<?>[1000];
+        for (int i = 0; i < futures.length; i++) {
+            futures[i] = abs.submit(-i);
+        }
+        for (int i = 0; i < futures.length; i++) {
+            assertEquals(i, ((PyObject) futures[i].get(10, TimeUnit.SECONDS)).getIntValue());
+        }
+
+        CompletableFuture<PyObject> sum = PyModule.importModule("math").callMethodAsync("fsum", (Object) new double[]{1.5, 2.5});
+        assertEquals(4.0, sum.get(10, TimeUnit.SECONDS).getDoubleValue(), 0.0);
+
+        CompletableFuture<PyObject> failed = builtins.callMethodAsync("int", "not a number");
+        try {
+            failed.get(10, TimeUnit.SECONDS);
+            fail("ExecutionException expected");
+        } catch (ExecutionException e) {
+            assertTrue(e.getCause() instanceof PyException);
+        }
+    }
+
 }
@@ -24,6 +24,7 @@ import org.jpy.fixtures.Processor;
 
 import java.io.File;
 import java.io.IOException;
+import java.util.ArrayList;
 import java.util.Arrays;
 import java.util.HashMap;
 import java.util.Map;
@@ -161,6 +162,22 @@ public class PyObjectTest {
         assertEquals(13, localMap.get("z"));
     }
     
+    @Test
+    public void testLocalsOnlyChangesCopiedBack() throws Exception {
+        Map<String, Object> localMap = new HashMap<>();
+        Short unchanged = (short) 5;
+        localMap.put("unchanged", unchanged);
+        localMap.put("reassigned", 1);
+        localMap.put("deleted", "gone");
+        PyObject.executeCode("reassigned = unchanged * 2\nadded = 'new'\ndel deleted", PyInputMode.SCRIPT, null, localMap);
+
+        // An unchanged value is not converted back, so it keeps its Java type and identity
+        assertSame(unchanged, localMap.get("unchanged"));
+        assertEquals(10, localMap.get("reassigned"));
+        assertEquals("new", localMap.get("added"));
+        assertFalse(localMap.containsKey("deleted"));
+    }
+
     @Test
     public void testExecuteScript_ErrorExpr() throws Exception {
         try {
@@ -171,6 +188,77 @@ public class PyObjectTest {
         }
     }
     
+    @Test
+    public void testPythonExceptions() throws Exception {
+        try {
+            PyObject.executeCode("1 / 0", PyInputMode.EXPRESSION);
+            fail();
+        } catch (PyException e) {
+            assertNotNull(e.getValue());
+            assertTrue(e.getMessage().contains("ZeroDivisionError"));
+            assertSame(e.getMessage(), e.getMessage());
+        }
+        try {
+            PyObject.executeCode("{}['missingKey']", PyInputMode.EXPRESSION);
+            fail();
+        } catch (KeyError e) {
+            assertTrue(e.getValue().getAttribute("args").toString().contains("missingKey"));
+            assertTrue(e.getMessage().contains("KeyError"));
+        }
+        try {
+            PyObject.executeCode("next(iter([]))", PyInputMode.EXPRESSION);
+            fail();
+        } catch (StopIteration e) {
+            assertTrue(e.getMessage().contains("StopIteration"));
+        }
+    }
+
+    @Test
+    public void testCompileAndExecute() throws Exception {
+        PyObject code = PyObject.compile("a * b", PyInputMode.EXPRESSION);
+        Map<String, Object> locals = new HashMap<>();
+        for (int i = 0; i < 3; i++) {
+            locals.put("a", i);
+            locals.put("b", 7);
+            assertEquals(7 * i, PyObject.executeCompiled(code, null, locals).getIntValue());
+        }
+
+        PyObject script = PyObject.compile("compiledX = 40\ncompiledY = compiledX + 2", PyInputMode.SCRIPT);
+        Map<String, Object> globals = new HashMap<>();
+        PyObject.executeCompiled(script, globals, null);
+        assertEquals(42, globals.get("compiledY"));
+
+        try {
+            PyObject.compile("[1, 2", PyInputMode.EXPRESSION);
+            fail();
+        } catch (RuntimeException e) {
+            assertTrue(e.getMessage().contains("SyntaxError"));
+        }
+
+        try {
+            PyObject.executeCompiled(PyObject.executeCode("42", PyInputMode.EXPRESSION), null, null);
+            fail();
+        } catch (PyException e) {
+            assertTrue(e.getMessage().contains("TypeError"));
+        }
+    }
+
+    @Test
+    public void testCodeCache() throws Exception {
+        PyObject.setCodeCacheSize(2);
+        try {
+            for (int i = 0; i < 5; i++) {
+                Map<String, Object> locals = new HashMap<>();
+                locals.put("n", i);
+                assertEquals(i + 1, PyObject.executeCode("n + 1", PyInputMode.EXPRESSION, null, locals).getIntValue());
+                assertEquals(2 * i, PyObject.executeCode("n * 2", PyInputMode.EXPRESSION, null, locals).getIntValue());
+                assertEquals(i - 1, PyObject.executeCode("n - 1", PyInputMode.EXPRESSION, null, locals).getIntValue());
+            }
+        } finally {
+            PyObject.setCodeCacheSize(0);
+        }
+    }
+
     @Test
     public void testCall() throws Exception {
         // Python equivalent:
@@ -191,6 +279,120 @@ public class PyObjectTest {
         Assert.assertEquals("Z", value.getStringValue());
     }
     
+    @Test
+    public void testGetCallable() throws Exception {
+        PyModule builtins;
+        try {
+            // Python 3.3
+            builtins = PyModule.importModule("builtins");
+        } catch (Exception e) {
+            // Python 2.7
+            builtins = PyModule.importModule("__builtin__");
+        }
+        PyCallable max = builtins.getCallable("max");
+        Assert.assertEquals("Z", max.call("A", "Z").getStringValue());
+        Assert.assertEquals("Z", max.call("Z", "A").getStringValue());
+
+        PyCallable typedMax = max.withParamTypes(Integer.class, Integer.class);
+        Assert.assertSame(typedMax, max.withParamTypes(Integer.class, Integer.class));
+        Assert.assertEquals(Integer.valueOf(7), typedMax.callAndReturnValue(Integer.class, 3, 7));
+        Assert.assertEquals(Integer.valueOf(5), typedMax.callAndReturnValue(Integer.class, 5, -1));
+
+        try {
+            typedMax.call(1, 2, 3);
+            Assert.fail();
+        } catch (IllegalArgumentException e) {
+            // expected: wrong argument count
+        }
+        try {
+            builtins.getCallable("__name__");
+            Assert.fail();
+        } catch (IllegalArgumentException e) {
+            // expected: not callable
+        }
+    }
+
+    @Test
+    public void testCallPrimitive() throws Exception {
+        PyModule builtins;
+        try {
+            // Python 3.3
+            builtins = PyModule.importModule("builtins");
+        } catch (Exception e) {
+            // Python 2.7
+            builtins = PyModule.importModule("__builtin__");
+        }
+        PyCallable max = builtins.getCallable("max");
+        PyCallable pow = builtins.getCallable("pow");
+        PyCallable abs = builtins.getCallable("abs");
+        Assert.assertEquals(2.5, max.callDouble(2.5, 1.0), 0.0);
+        Assert.assertEquals(4.0, max.callDouble(1.0, 4.0, 3.0, 2.0), 0.0);
+        Assert.assertEquals(1024L, pow.callLong(2L, 10L));
+        Assert.assertEquals(3L, abs.callLong(-3L));
+        Assert.assertEquals(Math.sqrt(2.0), pow.callDouble("JD", 2L, PyCallable.doubleArg(0.5)), 1e-12);
+        Assert.assertEquals(8.0, pow.callDouble("DJ", PyCallable.doubleArg(2.0), 3L), 0.0);
+        try {
+            pow.callDouble("JX", 2L, 3L);
+            Assert.fail();
+        } catch (IllegalArgumentException e) {
+            // expected: illegal argument type
+        }
+    }
+
+    @Test
+    public void testClose() throws Exception {
+        PyObject.executeCode("import sys\ncloseTestObj = object()", PyInputMode.SCRIPT);
+        PyObject obj = PyModule.importModule("__main__").getAttribute("closeTestObj");
+        int refCount = getCloseTestObjRefCount();
+        try (PyObject closed = obj) {
+            assertEquals(obj.getPointer(), closed.getPointer());
+        }
+        assertEquals(refCount - 1, getCloseTestObjRefCount());
+        // A second close() has no effect
+        obj.close();
+        assertEquals(refCount - 1, getCloseTestObjRefCount());
+
+        // Using the object afterwards fails instead of passing the released pointer
+        try {
+            obj.getPointer();
+            fail();
+        } catch (IllegalStateException e) {
+            // expected
+        }
+        try {
+            obj.getAttribute("__class__");
+            fail();
+        } catch (IllegalStateException e) {
+            // expected
+        }
+        try {
+            PyObject.executeCode("1 + 1", PyInputMode.EXPRESSION, obj, null);
+            fail();
+        } catch (IllegalStateException e) {
+            // expected, thrown by getPointer() called from native code
+        }
+        assertEquals(refCount - 1, getCloseTestObjRefCount());
+    }
+
+    private static int getCloseTestObjRefCount() {
+        return PyObject.executeCode("sys.getrefcount(closeTestObj)", PyInputMode.EXPRESSION).getIntValue();
+    }
+
+    @Test
+    public void testCallableReturnValueIsReleased() throws Exception {
+        PyObject.executeCode("import sys\ncloseTestObj = object()\ndef getCloseTestObj(x):\n    return closeTestObj", PyInputMode.SCRIPT);
+        PyCallable callable = PyModule.importModule("__main__").getCallable("getCloseTestObj");
+        int refCount = getCloseTestObjRefCount();
+        try (PyObject result = callable.call(1)) {
+            assertEquals(refCount + 1, getCloseTestObjRefCount());
+        }
+        assertEquals(refCount, getCloseTestObjRefCount());
+        try (PyObject result = callable.withParamTypes(Integer.class).call(1)) {
+            assertEquals(refCount + 1, getCloseTestObjRefCount());
+        }
+        assertEquals(refCount, getCloseTestObjRefCount());
+    }
+
     @Test
     public void testGetSetAttributes() throws Exception {
         // Python equivalent:
@@ -236,6 +438,59 @@ public class PyObjectTest {
         assertFalse(origHasX);
     }
     
+    @Test
+    public void testListWrapper() throws Exception {
+        List<PyObject> list = PyObject.executeCode("[10, 'a', 2.5]", PyInputMode.EXPRESSION).asList();
+        assertEquals(3, list.size());
+        assertEquals(10, list.get(0).getIntValue());
+        assertEquals("a", list.get(1).getStringValue());
+        assertEquals(2.5, list.get(2).getDoubleValue(), 0.0);
+        PyObject[] items = list.toArray(new PyObject[0]);
+        assertEquals(3, items.length);
+        assertEquals("a", items[1].getStringValue());
+        try {
+            list.get(3);
+            fail();
+        } catch (IndexOutOfBoundsException e) {
+            // expected
+        }
+    }
+
+    @Test
+    public void testDictWrapper() throws Exception {
+        PyDictWrapper dict = PyObject.executeCode("{'a': 1, 'b': 2, 3: 'c'}", PyInputMode.EXPRESSION).asDict();
+        assertEquals(3, dict.size());
+        assertTrue(dict.containsKey("a"));
+        assertTrue(dict.containsKey(3));
+        assertFalse(dict.containsKey("x"));
+        assertEquals(2, dict.get("b").getIntValue());
+        assertEquals("c", dict.get(3).getStringValue());
+        assertNull(dict.get("x"));
+        try {
+            // Lists are unhashable
+            dict.get(PyObject.executeCode("[]", PyInputMode.EXPRESSION));
+            fail();
+        } catch (PyException e) {
+            assertTrue(e.getMessage().contains("unhashable"));
+        }
+
+        int count = 0;
+        for (Map.Entry<PyObject, PyObject> entry : dict.entrySet()) {
+            assertEquals(dict.get(entry.getKey()).getPointer(), entry.getValue().getPointer());
+            count++;
+        }
+        assertEquals(3, count);
+        assertEquals(3, dict.keySet().size());
+        assertTrue(dict.keySet().contains("a"));
+        assertEquals(3, dict.values().size());
+
+        Map<PyObject, PyObject> snapshot = dict.snapshot();
+        assertEquals(3, snapshot.size());
+        for (Map.Entry<PyObject, PyObject> entry : snapshot.entrySet()) {
+            assertTrue(dict.containsKey(entry.getKey()));
+        }
+    }
+
     @Test
     public void testCreateProxyAndCallSingleThreaded() throws Exception {
         // addTestDirToPythonSysPath();
@@ -256,6 +511,34 @@ public class PyObjectTest {
         // PyLib.Diag.setFlags(PyLib.Diag.F_OFF);
     }
     
+    @Test
+    public void testCreateDispatchedProxyAndCallMultiThreaded() throws Exception {
+        PyModule procModule = PyModule.importModule("proc_class");
+        PyObject procObj = procModule.call("Processor");
+        final Processor processor = procObj.createDispatchedProxy(Processor.class);
+        assertEquals("initialize", processor.initialize());
+
+        ExecutorService executorService = Executors.newFixedThreadPool(8);
+        try {
+            List<Callable<String>> tasks = new ArrayList<>();
+            for (int i = 0; i < 16; i++) {
+                tasks.add(new ProcessorTask(processor, i, 100));
+            }
+            List<Future<String>> futures = executorService.invokeAll(tasks, 10, TimeUnit.SECONDS);
+            for (int i = 0; i < futures.size(); i++) {
+                assertEquals("computeTile-" + i + ",100", futures.get(i).get());
+            }
+        } finally {
+            executorService.shutdown();
+        }
+
+        // Calls made while holding the GIL don't wait for the executor thread
+        try (GilScope gil = PyLib.acquireGil()) {
+            assertEquals("computeTile-1,2", processor.computeTile(1, 2, new float[100 * 100]));
+        }
+        assertEquals("dispose", processor.dispose());
+    }
+
     static void testCallProxySingleThreaded(PyObject procObject) {
         // Cast the Python object to a Java object of type 'Processor'
         Processor processor = procObject.createProxy(Processor.class);
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.jpy.fixtures;
+
+import org.jpy.annotations.Mutable;
+import org.jpy.annotations.Output;
+import org.jpy.annotations.Return;
+
+/**
+ * Used as a test class for the test cases in jpy_modretparam_test.py.
+ * Unlike {@link ModifyAndReturnParametersTestFixture}, no Python type callback is registered for this class,
+ * so the parameter annotations alone control how arguments are passed.
+ */
+@SuppressWarnings("UnusedDeclaration")
+public class AnnotatedParametersTestFixture {
+
+    public AnnotatedParametersTestFixture() {
+    }
+
+    public AnnotatedParametersTestFixture(@Mutable int[] array) {
+        if (array != null) {
+            array[0] = -1;
+        }
+    }
+
+    public void modifyIntArray(@Mutable int[] array, int item0, int item1, int item2) {
+        array[0] = item0;
+        array[1] = item1;
+        array[2] = item2;
+    }
+
+    public void modifyIntArrayUnannotated(int[] array, int item0, int item1, int item2) {
+        array[0] = item0;
+        array[1] = item1;
+        array[2] = item2;
+    }
+
+    public int[] modifyAndReturnIntArray(@Mutable @Return int[] array, int item0, int item1, int item2) {
+        if (array == null) {
+            array = new int[3];
+        }
+        array[0] = item0;
+        array[1] = item1;
+        array[2] = item2;
+        return array;
+    }
+
+    public void outputIntArray(@Mutable @Output int[] array, int item0, int item1, int item2) {
+        array[0] = item0;
+        array[1] = item1;
+        array[2] = item2;
+    }
+}
@@ -0,0 +1,40 @@
+/*
+ * Copyright 2015 Brockmann Consult GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package org.jpy.fixtures;
+
+/**
+ * Used by the multi-threaded benchmark {@code jpy_mt_perf_test.py}: CPU-bound work that takes no locks.
+ */
+public class BenchmarkWork {
+
+    private static volatile long sink;
+
+    /**
+     * Performs {@code iterations} steps of a simple LCG computation.
+     *
+     * @return the nanoseconds spent in this method.
+     */
+    public static long work(int iterations) {
+        long t0 = System.nanoTime();
+        long x = iterations;
+        for (int i = 0; i < iterations; i++) {
+            x = x * 6364136223846793005L + 1442695040888963407L;
+        }
+        sink = x;
+        return System.nanoTime() - t0;
+    }
+}
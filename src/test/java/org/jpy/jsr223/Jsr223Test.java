@@ -16,16 +16,25 @@
 
 package org.jpy.jsr223;
 
+import org.jpy.PyException;
+import org.jpy.PyObject;
 import org.junit.Assert;
 import org.junit.Test;
 
+import javax.script.Compilable;
+import javax.script.CompiledScript;
+import javax.script.Invocable;
+import javax.script.ScriptContext;
 import javax.script.ScriptEngine;
 import javax.script.ScriptEngineFactory;
 import javax.script.ScriptEngineManager;
+import javax.script.ScriptException;
 import java.util.List;
 
 import static org.junit.Assert.assertEquals;
 import static org.junit.Assert.assertNotNull;
+import static org.junit.Assert.assertSame;
+import static org.junit.Assert.assertTrue;
 
 public class Jsr223Test {
 
@@ -44,6 +53,44 @@ public class Jsr223Test {
         assertEquals("3.x", scriptEngineFactory.getParameter(ScriptEngine.LANGUAGE_VERSION));
     }
 
+    @Test
+    public void testCompiledScriptAndInvokeFunction() throws Exception {
+        ScriptEngine engine = getScriptEngineFactory().getScriptEngine();
+        CompiledScript compiledScript = ((Compilable) engine).compile("def twice(x):\n    return 2 * x\n");
+        assertSame(engine, compiledScript.getEngine());
+        compiledScript.eval();
+        compiledScript.eval();
+
+        Invocable invocable = (Invocable) engine;
+        assertEquals(6, ((PyObject) invocable.invokeFunction("twice", 3)).getIntValue());
+        assertEquals(8, ((PyObject) invocable.invokeFunction("twice", 4)).getIntValue());
+
+        // Evaluating a script must invalidate cached functions
+        engine.eval("def twice(x):\n    return 3 * x\n");
+        assertEquals(9, ((PyObject) invocable.invokeFunction("twice", 3)).getIntValue());
+
+        // Top-level definitions of the scripts go to the engine scope bindings, not to __main__
+        assertTrue(engine.getBindings(ScriptContext.ENGINE_SCOPE).get("twice") instanceof PyObject);
+
+        try {
+            invocable.invokeFunction("no_such_function_37");
+            Assert.fail();
+        } catch (NoSuchMethodException expected) {
+            // ok
+        }
+    }
+
+    @Test
+    public void testCompileSyntaxError() throws Exception {
+        ScriptEngine engine = getScriptEngineFactory().getScriptEngine();
+        try {
+            ((Compilable) engine).compile("def twice(x) return 2 * x\n");
+            Assert.fail();
+        } catch (ScriptException expected) {
+            assertTrue(expected.getCause() instanceof PyException);
+        }
+    }
+
     private ScriptEngineFactoryImpl getScriptEngineFactory() {
         ScriptEngineManager engineManager = new ScriptEngineManager();
         List<ScriptEngineFactory> engineFactories = engineManager.getEngineFactories();
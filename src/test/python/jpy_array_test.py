@@ -1,10 +1,14 @@
 import unittest
+import array
+import os
 import sys
+import tempfile
 
 import jpyutil
 
 
-jpyutil.init_jvm(jvm_maxmem='512M', jvm_classpath=['target/test-classes'])
+# 'target/classes' provides org.jpy.MappedBuffers
+jpyutil.init_jvm(jvm_maxmem='512M', jvm_classpath=['target/test-classes', 'target/classes'])
 import jpy
 
 
@@ -201,6 +205,116 @@ class TestJavaArrays(unittest.TestCase):
         self.do_test_buffer_protocol_float('double', 8, [0.12345678, 0.0, -100.123456, 54.3], 8)
 
 
+    @unittest.skipIf(sys.version_info < (3, 0, 0), 'memoryview.release() requires Python 3')
+    def test_buffer_concurrent_exports(self):
+        a = jpy.array('int', [1, 2, 3, 4])
+        m1 = memoryview(a)
+        m2 = memoryview(a)
+        self.assertEqual(m1.shape, (4,))
+        self.assertEqual(m2.strides, (4,))
+        self.assertEqual(m1.tolist(), m2.tolist())
+        m1.release()
+        # The second export must stay valid after the first one has been released
+        self.assertEqual(m2.tolist(), [1, 2, 3, 4])
+        m2.release()
+        # Once all exports are released, new exports see changes made on the Java side
+        a[0] = 10
+        for i in range(1000):
+            m = memoryview(a)
+            self.assertEqual(m[0], 10)
+            m.release()
+
+
+    def test_array_too_large(self):
+        with self.assertRaises(ValueError):
+            jpy.array('int', 2 ** 31)
+
+
+    @unittest.skipIf(sys.version_info < (3, 0, 0), 'array.array has no buffer interface in Python 2.7')
+    def test_array_chunks(self):
+        values = array.array('d', [float(i) for i in range(10)])
+        chunks = jpy.array_chunks('double', values, 4)
+        self.assertEqual(type(chunks), jpy.get_type('[[D'))
+        self.assertEqual(len(chunks), 3)
+        self.assertEqual(len(chunks[0]), 4)
+        self.assertEqual(len(chunks[1]), 4)
+        self.assertEqual(len(chunks[2]), 2)
+        self.assertEqual(chunks[1][0], 4.0)
+        self.assertEqual(chunks[2][1], 9.0)
+
+        copy = array.array('d', [0.0] * 10)
+        self.assertEqual(jpy.copy_array_chunks(chunks, copy), 10)
+        self.assertEqual(copy, values)
+
+        with self.assertRaises(ValueError):
+            jpy.copy_array_chunks(chunks, array.array('d', [0.0] * 9))
+        with self.assertRaises(ValueError):
+            jpy.array_chunks('double', array.array('b', [1, 2, 3]))
+        with self.assertRaises(ValueError):
+            jpy.array_chunks('java.lang.String', values)
+        with self.assertRaises(ValueError):
+            jpy.array_chunks('double', values, 0)
+
+
+    @unittest.skipIf(sys.version_info < (3, 0, 0), 'array.array has no buffer interface in Python 2.7')
+    def test_array_chunks_empty(self):
+        chunks = jpy.array_chunks('int', array.array('i'))
+        self.assertEqual(len(chunks), 0)
+        self.assertEqual(jpy.copy_array_chunks(chunks, array.array('i')), 0)
+
+
+
+@unittest.skipIf(sys.version_info < (3, 0, 0), 'memoryview.cast() requires Python 3')
+class TestDirectByteBuffers(unittest.TestCase):
+    def test_direct_buffer_is_shared(self):
+        ByteBuffer = jpy.get_type('java.nio.ByteBuffer')
+        buf = ByteBuffer.allocateDirect(16)
+        view = memoryview(buf)
+        self.assertEqual(view.nbytes, 16)
+        self.assertFalse(view.readonly)
+        view[3] = 42
+        self.assertEqual(buf.get(3), 42)
+        buf.put(4, 17)
+        self.assertEqual(view[4], 17)
+
+    def test_read_only_direct_buffer(self):
+        ByteBuffer = jpy.get_type('java.nio.ByteBuffer')
+        buf = ByteBuffer.allocateDirect(8).asReadOnlyBuffer()
+        view = memoryview(buf)
+        self.assertTrue(view.readonly)
+        with self.assertRaises(TypeError):
+            view[0] = 1
+
+    def test_heap_buffer_not_exported(self):
+        ByteBuffer = jpy.get_type('java.nio.ByteBuffer')
+        with self.assertRaises(BufferError):
+            memoryview(ByteBuffer.allocate(8))
+
+    def test_mapped_file_typed_view(self):
+        MappedBuffers = jpy.get_type('org.jpy.MappedBuffers')
+        fd, path = tempfile.mkstemp()
+        os.close(fd)
+        try:
+            buf = MappedBuffers.map(path, True, 0, 8 * 4)
+            doubles = memoryview(buf).cast('d')
+            self.assertEqual(len(doubles), 4)
+            doubles[2] = 2.5
+            self.assertEqual(buf.asDoubleBuffer().get(2), 2.5)
+            buf.asDoubleBuffer().put(1, -1.25)
+            self.assertEqual(doubles[1], -1.25)
+            MappedBuffers.sync(buf)
+            doubles.release()
+            with open(path, 'rb') as f:
+                self.assertEqual(array.array('d', f.read())[2], 2.5)
+        finally:
+            del buf
+            try:
+                os.remove(path)
+            except OSError:
+                # Windows keeps the file locked until the mapping is collected
+                pass
+
+
 if __name__ == '__main__':
     print('\nRunning ' + __file__)
     unittest.main()
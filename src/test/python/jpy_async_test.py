@@ -0,0 +1,86 @@
+import asyncio
+import sys
+import threading
+import unittest
+import jpyutil
+
+jpyutil.init_jvm(jvm_maxmem='512M')
+import jpy
+
+
+def run(coroutine):
+    loop = asyncio.new_event_loop()
+    try:
+        return loop.run_until_complete(coroutine)
+    finally:
+        loop.close()
+
+
+class TestAsync(unittest.TestCase):
+
+    def setUp(self):
+        self.CompletableFuture = jpy.get_type('java.util.concurrent.CompletableFuture')
+
+    def test_await_completed_future(self):
+        future = self.CompletableFuture.completedFuture('done')
+
+        async def main():
+            return await future
+
+        self.assertEqual('done', run(main()))
+
+    def test_await_future_completed_by_other_thread(self):
+        future = self.CompletableFuture()
+        Integer = jpy.get_type('java.lang.Integer')
+
+        async def main():
+            threading.Timer(0.1, lambda: future.complete(Integer(42))).start()
+            return await future
+
+        self.assertEqual(42, run(main()))
+
+    def test_await_failed_future(self):
+        future = self.CompletableFuture()
+        IllegalStateException = jpy.get_type('java.lang.IllegalStateException')
+
+        async def main():
+            threading.Timer(0.1, lambda: future.completeExceptionally(IllegalStateException('boom'))).start()
+            await future
+
+        with self.assertRaises(jpy.JException) as e:
+            run(main())
+        self.assertIn('boom', str(e.exception))
+
+    def test_call_nogil(self):
+        String = jpy.get_type('java.lang.String')
+        self.assertEqual('3', jpy.call_nogil(String.valueOf, 3))
+
+    def test_call_async(self):
+        Thread = jpy.get_type('java.lang.Thread')
+        String = jpy.get_type('java.lang.String')
+        ticks = []
+
+        async def tick():
+            for i in range(3):
+                ticks.append(i)
+                await asyncio.sleep(0.01)
+
+        async def main():
+            # The event loop keeps running while Java sleeps
+            sleep = jpy.call_async(Thread.sleep, 200)
+            await asyncio.gather(sleep, tick())
+            return await jpy.call_async(String.valueOf, 7)
+
+        self.assertEqual('7', run(main()))
+        self.assertEqual([0, 1, 2], ticks)
+
+    @unittest.skipIf(sys.version_info < (3, 7), 'asyncio.get_running_loop() requires Python 3.7')
+    def test_call_async_without_running_loop(self):
+        String = jpy.get_type('java.lang.String')
+        with self.assertRaises(RuntimeError):
+            jpy.call_async(String.valueOf, 7)
+
+
+if __name__ == '__main__':
+    print('\nRunning ' + __file__)
+    unittest.main()
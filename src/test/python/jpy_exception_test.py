@@ -51,6 +51,20 @@ class TestExceptions(unittest.TestCase):
             fixture.throwIoeIfMessageIsNotNull("Evil!")
         self.assertEqual(str(e.exception), 'java.io.IOException: Evil!')
 
+    def test_JavaExceptionObject(self):
+        fixture = self.Fixture()
+        IOException = jpy.get_type('java.io.IOException')
+
+        with self.assertRaises(jpy.JException) as e:
+            fixture.throwIoeIfMessageIsNotNull("Evil!")
+        java_exception = e.exception.java_exception
+        self.assertTrue(isinstance(e.exception, RuntimeError))
+        self.assertTrue(isinstance(java_exception, IOException))
+        self.assertEqual(java_exception.getClass().getName(), 'java.io.IOException')
+        self.assertEqual(java_exception.getMessage(), 'Evil!')
+        self.assertEqual(e.exception.args, ('java.io.IOException: Evil!',))
+        self.assertEqual(str(e.exception), 'java.io.IOException: Evil!')
+
     # Checking the exceptions for differences (e.g. in white space) can be a huge pain, this helps)
     def hexdump(self, s):
         for i in range(0, len(s), 32):
@@ -5,7 +5,8 @@ import sys
 import jpyutil
 
 
-jpyutil.init_jvm(jvm_maxmem='512M', jvm_classpath=['target/test-classes'])
+# 'target/classes' provides the org.jpy.annotations read by jpy when it resolves the fixture types
+jpyutil.init_jvm(jvm_maxmem='512M', jvm_classpath=['target/test-classes', 'target/classes'])
 import jpy
 
 try:
@@ -40,6 +41,19 @@ def annotate_fixture_methods(type, method):
 jpy.type_callbacks['org.jpy.fixtures.ModifyAndReturnParametersTestFixture'] = annotate_fixture_methods
 
 
+annotated_param_flags = {}
+
+
+def record_annotated_param_flags(type, method):
+    # The flags of annotated parameters are already set when the type callback is invoked
+    if method.param_count > 0:
+        annotated_param_flags[method.name] = (method.is_param_mutable(0), method.is_param_output(0), method.is_param_return(0))
+    return True
+
+
+jpy.type_callbacks['org.jpy.fixtures.AnnotatedParametersTestFixture'] = record_annotated_param_flags
+
+
 class TestMutableAndReturnParameters(unittest.TestCase):
     def setUp(self):
         self.Fixture = jpy.get_type('org.jpy.fixtures.ModifyAndReturnParametersTestFixture')
@@ -263,6 +277,94 @@ class TestMutableAndReturnParameters(unittest.TestCase):
         self.assertEqual(a[2], 0)
 
 
+class TestAnnotatedParameters(unittest.TestCase):
+    def setUp(self):
+        self.Fixture = jpy.get_type('org.jpy.fixtures.AnnotatedParametersTestFixture')
+        self.assertIsNotNone(self.Fixture)
+
+
+    def test_annotationsAreVisibleToTypeCallbacks(self):
+        self.assertEqual(annotated_param_flags['modifyIntArray'], (True, False, False))
+        self.assertEqual(annotated_param_flags['modifyIntArrayUnannotated'], (False, False, False))
+        self.assertEqual(annotated_param_flags['modifyAndReturnIntArray'], (True, False, True))
+        self.assertEqual(annotated_param_flags['outputIntArray'], (True, True, False))
+
+
+    def test_modifyIntArray(self):
+        fixture = self.Fixture()
+
+        a = jpy.array('int', 3)
+        fixture.modifyIntArray(a, 12, 13, 14)
+        self.assertEqual(a[0], 12)
+        self.assertEqual(a[1], 13)
+        self.assertEqual(a[2], 14)
+
+        if sys.version_info >= (3, 0, 0):
+            a = array.array('i', [0, 0, 0])
+            fixture.modifyIntArray(a, 12, 13, 14)
+            self.assertEqual(a[0], 12)
+            self.assertEqual(a[1], 13)
+            self.assertEqual(a[2], 14)
+
+            # Without @Mutable, the Java array is a copy and changes are not written back
+            a = array.array('i', [0, 0, 0])
+            fixture.modifyIntArrayUnannotated(a, 12, 13, 14)
+            self.assertEqual(a[0], 0)
+            self.assertEqual(a[1], 0)
+            self.assertEqual(a[2], 0)
+
+
+    def test_modifyLargeIntArray(self):
+        # Only the first chunk of the Java array is changed, so only that one is copied back
+        fixture = self.Fixture()
+
+        if sys.version_info >= (3, 0, 0):
+            n = 100000
+            a = array.array('i', range(n))
+            fixture.modifyIntArray(a, -1, -2, -3)
+            self.assertEqual(a[0], -1)
+            self.assertEqual(a[1], -2)
+            self.assertEqual(a[2], -3)
+            self.assertEqual(a[3:], array.array('i', range(3, n)))
+
+
+    def test_mutableConstructorParameter(self):
+        if sys.version_info >= (3, 0, 0):
+            a = array.array('i', [0, 0, 0])
+            self.Fixture(a)
+            self.assertEqual(a[0], -1)
+
+
+    def test_modifyAndReturnIntArray(self):
+        fixture = self.Fixture()
+
+        if sys.version_info >= (3, 0, 0):
+            a1 = array.array('i', [0, 0, 0])
+            a2 = fixture.modifyAndReturnIntArray(a1, 16, 17, 18)
+            self.assertIs(a1, a2)
+            self.assertEqual(a2[0], 16)
+            self.assertEqual(a2[1], 17)
+            self.assertEqual(a2[2], 18)
+
+        a1 = jpy.array('int', 3)
+        a2 = fixture.modifyAndReturnIntArray(a1, 16, 17, 18)
+        self.assertIs(a1, a2)
+
+        a2 = fixture.modifyAndReturnIntArray(None, 16, 17, 18)
+        self.assertEqual(type(a2), jpy.get_type('[I'))
+
+
+    def test_outputIntArray(self):
+        fixture = self.Fixture()
+
+        if sys.version_info >= (3, 0, 0):
+            a = array.array('i', [1, 2, 3])
+            fixture.outputIntArray(a, 16, 17, 18)
+            self.assertEqual(a[0], 16)
+            self.assertEqual(a[1], 17)
+            self.assertEqual(a[2], 18)
+
+
 if __name__ == '__main__':
     print('\nRunning ' + __file__)
     unittest.main()
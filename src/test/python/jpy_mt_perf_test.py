@@ -0,0 +1,105 @@
+# Multi-threaded scaling benchmark for calls from Python into Java.
+#
+# Not run by default, requires the test fixture classes (target/test-classes) on the class path:
+#
+#     python jpy_mt_perf_test.py
+#
+# Each measurement is printed as a JSON object on a line of its own, or appended to the file named by
+# the environment variable JPY_BENCH_OUTPUT. Further environment variables:
+#   JPY_BENCH_THREADS      comma-separated thread counts, default "1,2,4,8,16,32,64"
+#   JPY_BENCH_DURATION     duration of each measurement in seconds, default 2.0
+#   JPY_BENCH_ITERATIONS   iterations of BenchmarkWork.work() per call, default 10000
+#
+# Modes: "gil" calls Java while holding the GIL, "nogil" calls it through jpy.call_nogil().
+# The "overhead_us" percentiles are the call latency minus the time spent in Java, that is the time
+# spent in jpy and waiting for the GIL. The Java-to-Python direction is measured by
+# src/test/java/org/jpy/MultiThreadBenchmark.java.
+
+import json
+import os
+import threading
+import time
+import unittest
+
+import jpyutil
+
+jpyutil.init_jvm(jvm_maxmem='512M', jvm_classpath=['target/test-classes'])
+import jpy
+
+THREAD_COUNTS = [int(n) for n in os.environ.get('JPY_BENCH_THREADS', '1,2,4,8,16,32,64').split(',')]
+DURATION = float(os.environ.get('JPY_BENCH_DURATION', '2.0'))
+ITERATIONS = int(os.environ.get('JPY_BENCH_ITERATIONS', '10000'))
+OUTPUT = os.environ.get('JPY_BENCH_OUTPUT')
+
+
+def percentiles(sorted_us):
+    if not sorted_us:
+        return None
+
+    def at(p):
+        return sorted_us[max(0, min(len(sorted_us) - 1, int(p * len(sorted_us) + 0.999999) - 1))]
+
+    return {'mean': sum(sorted_us) / len(sorted_us),
+            'p50': at(0.50), 'p90': at(0.90), 'p99': at(0.99), 'max': sorted_us[-1]}
+
+
+def report(result):
+    line = json.dumps(result)
+    if OUTPUT:
+        with open(OUTPUT, 'a') as f:
+            f.write(line + '\n')
+    else:
+        print(line)
+
+
+class TestMultiThreadPerformance(unittest.TestCase):
+
+    def setUp(self):
+        self.BenchmarkWork = jpy.get_type('org.jpy.fixtures.BenchmarkWork')
+
+    def measure(self, mode, thread_count):
+        work = self.BenchmarkWork.work
+        call_nogil = jpy.call_nogil
+        start = threading.Barrier(thread_count + 1)
+        samples = [[] for _ in range(thread_count)]
+        deadline = [0.0]
+
+        def run(latencies):
+            start.wait()
+            while time.perf_counter() < deadline[0]:
+                t0 = time.perf_counter_ns()
+                if mode == 'nogil':
+                    java_ns = call_nogil(work, ITERATIONS)
+                else:
+                    java_ns = work(ITERATIONS)
+                t1 = time.perf_counter_ns()
+                latencies.append((t1 - t0, java_ns))
+
+        threads = [threading.Thread(target=run, args=(samples[i],)) for i in range(thread_count)]
+        for t in threads:
+            t.start()
+        t0 = time.perf_counter()
+        deadline[0] = t0 + DURATION
+        start.wait()
+        for t in threads:
+            t.join()
+        seconds = time.perf_counter() - t0
+
+        all_samples = [s for latencies in samples for s in latencies]
+        latency_us = sorted(total / 1000.0 for total, _ in all_samples)
+        overhead_us = sorted(max(0, total - java_ns) / 1000.0 for total, java_ns in all_samples)
+        return {'benchmark': 'python-to-java', 'mode': mode, 'threads': thread_count,
+                'ops': len(all_samples), 'seconds': seconds, 'ops_per_sec': len(all_samples) / seconds,
+                'latency_us': percentiles(latency_us), 'overhead_us': percentiles(overhead_us)}
+
+    def test_python_to_java_scaling(self):
+        for mode in ('gil', 'nogil'):
+            for thread_count in THREAD_COUNTS:
+                result = self.measure(mode, thread_count)
+                self.assertTrue(result['ops'] > 0)
+                report(result)
+
+
+if __name__ == '__main__':
+    print('\nRunning ' + __file__)
+    unittest.main()
@@ -43,6 +43,54 @@ class TestMultipleThreads(unittest.TestCase):
         self.assertEqual(345, t3.intValue)
         self.assertEqual(456, t4.intValue)
 
+    def test_threads_attached_and_detached(self):
+        stats = jpy.thread_stats()
+
+        threads = [MyThread(value) for value in range(4)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+
+        new_stats = jpy.thread_stats()
+        self.assertEqual(4, new_stats['attached'] - stats['attached'])
+        self.assertEqual(4, new_stats['detached'] - stats['detached'])
+        self.assertEqual(stats['active'], new_stats['active'])
+
+    def test_set_daemon_attach(self):
+        self.assertTrue(jpy.set_daemon_attach(False))
+        try:
+            t = MyThread(567)
+            t.start()
+            t.join()
+            self.assertEqual(567, t.intValue)
+        finally:
+            self.assertFalse(jpy.set_daemon_attach(True))
+
+    def test_concurrent_type_resolution(self):
+        # All threads use the unresolved type at once, none of them must see it partially resolved
+        SkipListMap = jpy.get_type('java.util.concurrent.ConcurrentSkipListMap', resolve=False)
+        barrier = threading.Barrier(8)
+        errors = []
+
+        def use_type(value):
+            try:
+                barrier.wait()
+                m = SkipListMap()
+                m.put(value, str(value))
+                self.assertEqual(value, m.firstKey())
+                self.assertEqual(str(value), m.get(value))
+            except Exception as e:
+                errors.append(e)
+
+        threads = [threading.Thread(target=use_type, args=(value,)) for value in range(8)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+
+        self.assertEqual([], errors)
+
 
 if __name__ == '__main__':
     print('\nRunning ' + __file__)